@@ -0,0 +1,117 @@
+// WireSlave CRC Benchmark
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Times every CRC variant that packets can use (see WireFrame.h
+// and WireCrc.h) over a full packet payload, and prints the
+// result of each pass so the variants can be checked against
+// each other. Needs no I2C device.
+//
+// CRC8 bitwise is the loop used by previous versions, kept here
+// as reference. On the ESP32, CRC-16 and CRC-32 are timed both
+// with the chip ROM routines, used by the library, and with the
+// lookup tables used on other boards.
+
+#include <Arduino.h>
+#include <WireCrc.h>
+
+// largest payload of a packet with CRC-32
+#define PAYLOAD_LENGTH 121
+#define PASSES 1000
+
+uint8_t payload[PAYLOAD_LENGTH];
+
+uint8_t crc8Bitwise(const uint8_t *data, size_t length)
+{
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t extract = data[i];
+
+        for (char j = 8; j; j--) {
+            uint8_t sum = (crc ^ extract) & 0x01;
+            crc >>= 1;
+            if (sum) {
+                crc ^= 0x8C;
+            }
+            extract >>= 1;
+        }
+    }
+
+    return crc;
+}
+
+uint32_t crc8Table(const uint8_t *data, size_t length)
+{
+    WireCrc crc8;
+    return crc8.calc((uint8_t*) data, length);
+}
+
+uint32_t crc8Reference(const uint8_t *data, size_t length)
+{
+    return crc8Bitwise(data, length);
+}
+
+uint32_t crc16Table(const uint8_t *data, size_t length)
+{
+    return wireCrc16Table(0, data, length);
+}
+
+uint32_t crc16(const uint8_t *data, size_t length)
+{
+    return wireCrc16(0, data, length);
+}
+
+uint32_t crc32Table(const uint8_t *data, size_t length)
+{
+    return wireCrc32Table(0, data, length);
+}
+
+uint32_t crc32(const uint8_t *data, size_t length)
+{
+    return wireCrc32(0, data, length);
+}
+
+void benchmark(const char *name, uint32_t (*function)(const uint8_t*, size_t))
+{
+    uint32_t crc = 0;
+    unsigned long start = micros();
+
+    for (int i = 0; i < PASSES; ++i) {
+        crc = function(payload, PAYLOAD_LENGTH);
+    }
+
+    unsigned long elapsed = micros() - start;
+
+    // nanoseconds per byte
+    unsigned long perByte = elapsed * 1000UL / (PASSES * (unsigned long) PAYLOAD_LENGTH);
+
+    Serial.printf("%-16s %8lu us  %5lu ns/byte  crc %08X\n",
+        name, elapsed, perByte, crc);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    for (int i = 0; i < PAYLOAD_LENGTH; ++i) {
+        payload[i] = i * 37 + 11;
+    }
+
+    Serial.printf("%d passes over %d bytes\n", PASSES, PAYLOAD_LENGTH);
+
+    benchmark("CRC8 bitwise", crc8Reference);
+    benchmark("CRC8 table", crc8Table);
+    benchmark("CRC-16 table", crc16Table);
+    benchmark("CRC-32 table", crc32Table);
+
+#ifdef ARDUINO_ARCH_ESP32
+    benchmark("CRC-16 ROM", crc16);
+    benchmark("CRC-32 ROM", crc32);
+#endif
+}
+
+void loop()
+{
+    delay(1000);
+}
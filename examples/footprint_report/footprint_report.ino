@@ -0,0 +1,317 @@
+// WireSlave Footprint Report
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Reports what the library costs for a given configuration, so
+// footprint and latency regressions show up before a release:
+//
+//  - static RAM: sizeof() of each class, and of the two global
+//    TwoWireSlave instances, WireSlave and WireSlave1;
+//  - stack: peak stack used by each public call, measured by
+//    running it in a task of its own;
+//  - time: average CPU cycles of the main calls, including
+//    TwoWireSlave::update() with no data (readTimeout 0, so the
+//    driver read doesn't wait for a tick), the slave handling of a
+//    request and of an acknowledged write fed to processInput(),
+//    and WireSlaveRequest::request() against a fake bus;
+//  - flash: sketch size. Build it once with every REPORT_ option
+//    below set to 0, then with one of them set to 1; the size
+//    difference is the code size of that feature.
+//
+// Needs no I2C device: the slave is started on free pins and
+// the master side talks to FakeBus, which answers requests with
+// a packet of RESPONSE_LENGTH bytes and writes with an ACK.
+
+#include <Arduino.h>
+#include <WireSlave.h>
+#include <WireSlaveRequest.h>
+#include <WireSlaveWrite.h>
+#include <WirePacketPool.h>
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+
+#define RESPONSE_LENGTH 32
+#define RUNS 1000
+#define TASK_STACK 8192
+
+// features built in, see flash above
+#define REPORT_FEC 0
+#define REPORT_COBS 0
+#define REPORT_CRC32 0
+
+// master side bus without a slave: reads get a packet made as
+// TwoWireSlave would, an ACK holding the CRC of a FRAME_WRITE
+// packet after one
+class FakeBus : public WireTransport
+{
+public:
+    bool write(uint8_t address, const uint8_t *data, size_t length)
+    {
+        // with COBS, the start byte follows the code byte
+        uint8_t start = length > 1 ? data[REPORT_COBS ? 1 : 0] : 0;
+        isWrite_ = wireFrameType(start) == FRAME_WRITE;
+        if (isWrite_) {
+            WireUnpacker unpacker;
+            unpacker.setFec(REPORT_FEC);
+            unpacker.setFraming(REPORT_COBS ? FRAMING_COBS : FRAMING_STX);
+            unpacker.write(data, length);
+            writeCrc_ = unpacker.crc();
+        }
+        return true;
+    }
+
+    size_t read(uint8_t address, uint8_t *data, size_t length)
+    {
+        WirePacker packer;
+        configure(packer);
+        if (isWrite_) {
+            packer.reset(FRAME_ACK);
+            for (uint8_t i = 0; i < wireCrcLength(packer.crcWidth()); ++i) {
+                packer.write(uint8_t(writeCrc_ >> (8 * i)));
+            }
+        }
+        else {
+            for (uint8_t i = 0; i < RESPONSE_LENGTH; ++i) {
+                packer.write(i);
+            }
+        }
+        packer.end();
+
+        memset(data, 0xFF, length);
+        packer.read(data, length);
+        return length;
+    }
+
+    size_t writeRead(uint8_t address, const uint8_t *output, size_t outputLength,
+            uint8_t *input, size_t inputLength)
+    {
+        write(address, output, outputLength);
+        return read(address, input, inputLength);
+    }
+
+    void delay(unsigned long ms) {}
+
+    uint32_t micros()
+    {
+        return ::micros();
+    }
+
+    template <class T>
+    static void configure(T &object)
+    {
+#if REPORT_FEC
+        object.setFec(true);
+#endif
+#if REPORT_COBS
+        object.setFraming(FRAMING_COBS);
+#endif
+#if REPORT_CRC32
+        object.setCrc(CRC_32);
+#endif
+    }
+
+private:
+    bool isWrite_ = false;
+    uint32_t writeCrc_ = 0;
+};
+
+FakeBus bus;
+WireSlaveRequest slaveRequest(bus, I2C_SLAVE_ADDR, RESPONSE_LENGTH);
+WireSlaveWrite slaveWrite(bus, I2C_SLAVE_ADDR);
+
+uint8_t packet[PACKER_BUFFER_LENGTH];
+size_t packetLength = 0;
+
+// what the slave gets from a master, see setup()
+uint8_t requestPacket[PACKER_BUFFER_LENGTH];
+size_t requestLength = 0;
+uint8_t writePacket[PACKER_BUFFER_LENGTH];
+size_t writeLength = 0;
+
+void onSlaveRequest()
+{
+    for (uint8_t i = 0; i < RESPONSE_LENGTH; ++i) {
+        WireSlave.write(i);
+    }
+}
+
+void onSlaveReceive(int length)
+{
+    while (WireSlave.available()) {
+        WireSlave.read();
+    }
+}
+
+void callNothing() {}
+
+void callPackerEnd()
+{
+    WirePacker packer;
+    FakeBus::configure(packer);
+    for (uint8_t i = 0; i < RESPONSE_LENGTH; ++i) {
+        packer.write(i);
+    }
+    packer.end();
+    packetLength = packer.read(packet, sizeof(packet));
+}
+
+void callUnpackerWrite()
+{
+    // the CRC width is detected from the packet
+    WireUnpacker unpacker;
+    unpacker.setFec(REPORT_FEC);
+    unpacker.setFraming(REPORT_COBS ? FRAMING_COBS : FRAMING_STX);
+    unpacker.write(packet, packetLength);
+}
+
+void callSlaveUpdate()
+{
+    WireSlave.update();
+}
+
+void callSlaveRequest()
+{
+    WireSlave.processInput(requestPacket, requestLength);
+}
+
+void callSlaveReceive()
+{
+    WireSlave.processInput(writePacket, writeLength);
+}
+
+void callRequest()
+{
+    slaveRequest.request();
+}
+
+void callSend()
+{
+    for (uint8_t i = 0; i < RESPONSE_LENGTH; ++i) {
+        slaveWrite.write(i);
+    }
+    slaveWrite.send();
+}
+
+struct Call
+{
+    const char *name;
+    void (*function)();
+};
+
+const Call calls[] = {
+    { "WirePacker end()", callPackerEnd },
+    { "WireUnpacker write()", callUnpackerWrite },
+    { "TwoWireSlave update()", callSlaveUpdate },
+    { "TwoWireSlave request", callSlaveRequest },
+    { "TwoWireSlave write", callSlaveReceive },
+    { "WireSlaveRequest request()", callRequest },
+    { "WireSlaveWrite send()", callSend },
+};
+
+TaskHandle_t reportTask;
+void (*measuredCall)();
+UBaseType_t stackLeft;
+
+void stackTask(void *arg)
+{
+    measuredCall();
+
+    // ESP-IDF counts stack in bytes
+    stackLeft = uxTaskGetStackHighWaterMark(NULL);
+    xTaskNotifyGive(reportTask);
+    vTaskDelete(NULL);
+}
+
+// peak stack of a call, task overhead included
+size_t stackPeak(void (*function)())
+{
+    measuredCall = function;
+    reportTask = xTaskGetCurrentTaskHandle();
+    xTaskCreate(stackTask, "stack", TASK_STACK, NULL, 1, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return TASK_STACK - stackLeft;
+}
+
+uint32_t averageCycles(void (*function)())
+{
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; ++i) {
+        function();
+    }
+    return (ESP.getCycleCount() - start) / RUNS;
+}
+
+void printSize(const char *name, size_t size)
+{
+    Serial.printf("  %-28s %6u bytes\n", name, size);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    // update() must not wait for data that never comes
+    TwoWireSlaveConfig config;
+    config.readTimeout = 0;
+
+    bool success = WireSlave.begin(SDA_PIN, SCL_PIN, I2C_SLAVE_ADDR, config);
+    if (!success) {
+        Serial.println("I2C slave init failed");
+        while(1) delay(100);
+    }
+    FakeBus::configure(WireSlave);
+    WireSlave.onRequest(onSlaveRequest);
+    WireSlave.onReceive(onSlaveReceive);
+    FakeBus::configure(slaveRequest);
+    FakeBus::configure(slaveWrite);
+    slaveRequest.setRetryDelay(0);
+
+    Serial.printf("REPORT_FEC %d, REPORT_COBS %d, REPORT_CRC32 %d\n",
+        REPORT_FEC, REPORT_COBS, REPORT_CRC32);
+
+    Serial.println("static RAM");
+    printSize("WirePacker", sizeof(WirePacker));
+    printSize("WireUnpacker", sizeof(WireUnpacker));
+    printSize("TwoWireSlave", sizeof(TwoWireSlave));
+    printSize("WireSlave + WireSlave1", sizeof(WireSlave) + sizeof(WireSlave1));
+    printSize("WireSlaveRequest", sizeof(WireSlaveRequest));
+    printSize("WireSlaveWrite", sizeof(WireSlaveWrite));
+    printSize("shared WirePacketPool", sizeof(WirePacketPool)
+        + WIREPOOL_SHARED_BLOCKS * sizeof(WireUnpacker));
+
+    Serial.println("flash");
+    printSize("sketch", ESP.getSketchSize());
+
+    // a packet for callUnpackerWrite()
+    callPackerEnd();
+
+    // an empty packet triggers onRequest()
+    WirePacker packer;
+    FakeBus::configure(packer);
+    packer.end();
+    requestLength = packer.read(requestPacket, sizeof(requestPacket));
+
+    packer.reset(FRAME_WRITE);
+    for (uint8_t i = 0; i < RESPONSE_LENGTH; ++i) {
+        packer.write(i);
+    }
+    packer.end();
+    writeLength = packer.read(writePacket, sizeof(writePacket));
+
+    size_t stackBase = stackPeak(callNothing);
+
+    Serial.printf("%d byte payload, %d runs\n", RESPONSE_LENGTH, RUNS);
+    Serial.printf("  %-28s %6s %8s\n", "call", "stack", "cycles");
+    for (size_t i = 0; i < sizeof(calls) / sizeof(calls[0]); ++i) {
+        size_t stack = stackPeak(calls[i].function) - stackBase;
+        uint32_t cycles = averageCycles(calls[i].function);
+        Serial.printf("  %-28s %6u %8u\n", calls[i].name, stack, (unsigned) cycles);
+    }
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,64 @@
+// Wire Master Bulk Writer
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Demonstrates use of the WireBulkWrite class.
+// Sends 16 KiB to an ESP32 I2C/TWI slave device that uses
+// ESP32 I2C Slave library, keeping a window of chunks in flight.
+// The bytes are generated on the fly by a source callback,
+// as they would be read from a file.
+// Refer to the "slave_bulk_receiver" example for use with this
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WireBulkWrite.h>
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+
+#define TRANSFER_LENGTH 16384
+
+size_t readSource(uint32_t offset, uint8_t *buffer, size_t length);
+
+void setup()
+{
+    Serial.begin(115200);           // start serial for output
+    Wire.begin(SDA_PIN, SCL_PIN);   // join i2c bus
+}
+
+void loop()
+{
+    static unsigned long lastWireTransmit = 0;
+
+    // send the data every 10 seconds
+    if (millis() - lastWireTransmit > 10000) {
+        // first argument is the Wire bus the slave is attached to (Wire or Wire1)
+        WireBulkWrite bulkWrite(Wire, I2C_SLAVE_ADDR);
+
+        unsigned long start = millis();
+
+        // sending starts from the offset the slave expects,
+        // so an interrupted transfer continues where it stopped
+        if (bulkWrite.send(readSource, TRANSFER_LENGTH)) {
+            Serial.printf("sent %u bytes in %lu ms\n",
+                    TRANSFER_LENGTH, millis() - start);
+        }
+        else {
+            // if something went wrong, print the reason
+            Serial.printf("stopped at %u: %s\n", bulkWrite.offset(),
+                    bulkWrite.lastStatusToString().c_str());
+        }
+
+        lastWireTransmit = millis();
+    }
+}
+
+// copies up to length bytes, starting at offset, to buffer
+size_t readSource(uint32_t offset, uint8_t *buffer, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = uint8_t(offset + i);
+    }
+    return length;
+}
@@ -0,0 +1,67 @@
+// Wire Master Messages
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Demonstrates use of messages declared in messages.h
+// (see WireMessage.h) with WireSlaveWrite and WireSlaveRequest.
+// Blinks the slave LED with SetLed messages, and reads
+// SensorReading messages from it.
+// Refer to the "slave_messages" example for use with this
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WireSlaveRequest.h>
+#include <WireSlaveWrite.h>
+#include "messages.h"
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+
+void setup()
+{
+    Serial.begin(115200);           // start serial for output
+    Wire.begin(SDA_PIN, SCL_PIN);   // join i2c bus
+}
+
+void loop()
+{
+    static unsigned long lastWireTransmit = 0;
+    static bool isLedOn = false;
+
+    // talk to the slave every 1000 ms
+    if (millis() - lastWireTransmit > 1000) {
+        isLedOn = !isLedOn;
+
+        SetLed setLed;
+        setLed.on = isLedOn;
+
+        // first argument is the Wire bus the slave is attached to (Wire or Wire1)
+        WireSlaveWrite slaveWrite(Wire, I2C_SLAVE_ADDR);
+        setLed.writeTo(slaveWrite);
+
+        if (!slaveWrite.send()) {
+            Serial.println(slaveWrite.lastStatusToString());
+        }
+
+        // the response length is known at compile time
+        WireSlaveRequest slaveReq(Wire, I2C_SLAVE_ADDR, SensorReading::LENGTH);
+        SensorReading reading;
+
+        if (slaveReq.request()) {
+            if (reading.readFrom(slaveReq)) {
+                Serial.printf("uptime %u ms, temperature %.1f, %.2f V\n",
+                        reading.uptime, reading.temperature / 10.0, reading.voltage);
+            }
+            else {
+                Serial.println("unexpected message");
+            }
+        }
+        else {
+            // if something went wrong, print the reason
+            Serial.println(slaveReq.lastStatusToString());
+        }
+
+        lastWireTransmit = millis();
+    }
+}
@@ -0,0 +1,52 @@
+// Wire Master Writer with acknowledge
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Demonstrates use of the WireSlaveWrite class.
+// Writes data to an ESP32 I2C/TWI slave device that
+// uses ESP32 I2C Slave library, and checks if the slave
+// received it, sending it again if needed.
+// Refer to the "slave_receiver" example for use with this
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WireSlaveWrite.h>
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+
+void setup()
+{
+    Serial.begin(115200);           // start serial for output
+    Wire.begin(SDA_PIN, SCL_PIN);   // join i2c bus
+}
+
+void loop()
+{
+    static unsigned long lastWireTransmit = 0;
+    static byte x = 0;
+
+    // send data to WireSlave device every 1000 ms
+    if (millis() - lastWireTransmit > 1000) {
+        // first create a WireSlaveWrite object
+        // first argument is the Wire bus the slave is attached to (Wire or Wire1)
+        WireSlaveWrite slaveWrite(Wire, I2C_SLAVE_ADDR);
+
+        // then add data the same way as you would with Wire
+        slaveWrite.print("x is ");
+        slaveWrite.write(x);
+
+        // send the packet and wait for the slave acknowledge.
+        // the packet is sent again if the slave doesn't acknowledge it
+        if (slaveWrite.send()) {
+            x++;
+        }
+        else {
+            // if something went wrong, print the reason
+            Serial.println(slaveWrite.lastStatusToString());
+        }
+
+        lastWireTransmit = millis();
+    }
+}
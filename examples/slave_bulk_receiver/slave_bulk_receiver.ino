@@ -0,0 +1,65 @@
+// WireSlave Bulk Receiver
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Demonstrates use of the WireSlave library for ESP32.
+// Receives a bulk transfer as an I2C/TWI slave device, one
+// chunk at a time, checking every byte instead of storing it.
+// Refer to the "master_bulk_writer" example for use with this
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WireSlave.h>
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+
+#define TRANSFER_LENGTH 16384
+
+bool chunkSink(uint32_t offset, const uint8_t *data, size_t length);
+
+void setup()
+{
+    Serial.begin(115200);
+
+    bool success = WireSlave.begin(SDA_PIN, SCL_PIN, I2C_SLAVE_ADDR);
+    if (!success) {
+        Serial.println("I2C slave init failed");
+        while(1) delay(100);
+    }
+
+    WireSlave.onChunk(chunkSink);
+}
+
+void loop()
+{
+    // chunks are handed to chunkSink() inside update(), so
+    // call it often to keep the driver buffer from filling up
+    WireSlave.update();
+
+    static bool isComplete = false;
+    if (!isComplete && WireSlave.chunkOffset() == TRANSFER_LENGTH) {
+        // call WireSlave.setChunkOffset(0) to receive another one
+        Serial.println("transfer complete");
+        isComplete = true;
+    }
+
+    // let I2C and other ESP32 peripherals interrupts work
+    delay(1);
+}
+
+// function that executes with every chunk, in order, as it
+// would write it to flash. Returning false refuses the chunk,
+// and the master sends it again.
+// this function is registered as an event, see setup()
+bool chunkSink(uint32_t offset, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != uint8_t(offset + i)) {
+            Serial.printf("wrong byte at %u\n", offset + i);
+            return false;
+        }
+    }
+    return true;
+}
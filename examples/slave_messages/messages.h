@@ -0,0 +1,24 @@
+// Message list shared by the "master_messages" and "slave_messages"
+// examples: both sketches must be built with the same one.
+// See WireMessage.h for the format.
+
+#ifndef messages_h
+#define messages_h
+
+#include <WireMessage.h>
+
+#define SENSOR_READING(FIELD) \
+    FIELD(uint32_t, uptime) \
+    FIELD(int16_t, temperature) \
+    FIELD(float, voltage)
+
+#define SET_LED(FIELD) \
+    FIELD(bool, on)
+
+#define MESSAGES(MESSAGE) \
+    MESSAGE(SensorReading, 0x20, SENSOR_READING) \
+    MESSAGE(SetLed, 0x21, SET_LED)
+
+WIRE_MESSAGES(Messages, MESSAGES)
+
+#endif
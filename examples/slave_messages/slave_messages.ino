@@ -0,0 +1,88 @@
+// WireSlave Messages
+// by Gutierrez PS <https://github.com/gutierrezps>
+// ESP32 I2C slave library: <https://github.com/gutierrezps/ESP32_I2C_Slave>
+
+// Demonstrates use of the WireSlave library for ESP32 with
+// messages declared in messages.h (see WireMessage.h).
+// Switches the LED when a SetLed message is received, and
+// answers requests with a SensorReading message.
+// Refer to the "master_messages" example for use with this
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WireSlave.h>
+#include "messages.h"
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define I2C_SLAVE_ADDR 0x04
+#define LED_PIN 2
+
+// receives the messages, one onMessage() overload for each
+// message of the list
+struct MessageHandler
+{
+    void onMessage(const SetLed &message)
+    {
+        digitalWrite(LED_PIN, message.on ? HIGH : LOW);
+    }
+
+    void onMessage(const SensorReading &message)
+    {
+        // sent by the slave only
+    }
+};
+
+MessageHandler handler;
+
+void receiveEvent(int howMany);
+void requestEvent();
+
+void setup()
+{
+    Serial.begin(115200);
+    pinMode(LED_PIN, OUTPUT);
+
+    bool success = WireSlave.begin(SDA_PIN, SCL_PIN, I2C_SLAVE_ADDR);
+    if (!success) {
+        Serial.println("I2C slave init failed");
+        while(1) delay(100);
+    }
+
+    WireSlave.onReceive(receiveEvent);
+    WireSlave.onRequest(requestEvent);
+}
+
+void loop()
+{
+    // the slave response time is directly related to how often
+    // this update() method is called, so avoid using long delays
+    // inside loop(), and be careful with time-consuming tasks
+    WireSlave.update();
+
+    // let I2C and other ESP32 peripherals interrupts work
+    delay(1);
+}
+
+// function that executes whenever a complete and valid packet
+// is received from master
+// this function is registered as an event, see setup()
+void receiveEvent(int howMany)
+{
+    // calls the handler overload of the message ID
+    if (!Messages::dispatch(handler, WireSlave)) {
+        Serial.println("unknown message");
+    }
+}
+
+// function that executes whenever the master requests data
+// this function is registered as an event, see setup()
+void requestEvent()
+{
+    SensorReading reading;
+    reading.uptime = millis();
+    reading.temperature = temperatureRead() * 10;
+    reading.voltage = analogReadMilliVolts(A0) / 1000.0;
+
+    reading.writeTo(WireSlave);
+}
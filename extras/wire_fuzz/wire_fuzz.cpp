@@ -0,0 +1,552 @@
+/**
+ * @file wire_fuzz.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Random-stream fuzzer and throughput stress of WireUnpacker
+ * @date 2026-10-18
+ *
+ * Check mode (default): packs random payloads with WirePacker, with
+ * every packet type, framing, CRC width and FEC setting, mutates
+ * most of them (flipped bits, changed, inserted and removed bytes,
+ * truncation, pure noise) and feeds each one to a reset WireUnpacker.
+ * The result must match the one of the reference decoder below,
+ * written from the packet format and not from WireUnpacker: same
+ * accept or reject, same type, CRC width, payload and corrected
+ * bits. Unmodified packets must give back their payload. Prints
+ * each mismatch and exits with 1 if there was any.
+ *
+ * Stress mode (-t): concatenates valid and corrupt packets into a
+ * stream, feeds it byte by byte as TwoWireSlave::processInput()
+ * does for the given time, and reports decoded frames per second.
+ *
+ * Build it with the sanitizers so memory errors stop the run, from
+ * this directory:
+ *      g++ -std=gnu++11 -O1 -g -fsanitize=address,undefined \
+ *          -fno-sanitize-recover=undefined -I../../src \
+ *          -o wire_fuzz wire_fuzz.cpp ../../src/WirePacker.cpp \
+ *          ../../src/WireUnpacker.cpp ../../src/WireCrc.cpp
+ *
+ * For stress figures, build it again with -O2 and no sanitizers.
+ *
+ * Usage:
+ *      wire_fuzz [-n frames] [-s seed] [-t seconds] [-c corrupt_percent]
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include <WirePacker.h>
+#include <WireUnpacker.h>
+#include <WireFec.h>
+
+struct Settings
+{
+    WireFrameType type;
+    WireCrcWidth crc;
+    WireFraming framing;
+    bool fec;
+};
+
+struct Decoded
+{
+    bool accepted;
+    WireFrameType type;
+    WireCrcWidth crc;
+    uint8_t correctedBits;
+    std::vector<uint8_t> payload;
+};
+
+static const WireFrameType frameTypes[] = {
+    FRAME_DATA, FRAME_REQUEST, FRAME_WRITE, FRAME_BROADCAST,
+    FRAME_ACK, FRAME_NAK, FRAME_CHUNK, FRAME_SYNC,
+};
+
+static const WireCrcWidth crcWidths[] = { CRC_8, CRC_16, CRC_32 };
+
+static uint32_t seed = 1;
+
+// xorshift32, so that a failing run can be repeated with -s
+static uint32_t random32()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static uint32_t randomBelow(uint32_t limit)
+{
+    return random32() % limit;
+}
+
+
+// reference decoder
+
+static bool isKnownType(uint8_t start)
+{
+    if ((start & 0xC0) == 0xC0) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(frameTypes); ++i) {
+        if ((start & 0x3F) == frameTypes[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t crcLength(WireCrcWidth crc)
+{
+    return crc == CRC_32 ? 4 : (crc == CRC_16 ? 2 : 1);
+}
+
+// bit by bit, not the lookup tables of WireCrc
+static uint32_t referenceCrc(WireCrcWidth width, uint8_t length,
+        const uint8_t *data, size_t count)
+{
+    if (width == CRC_8) {
+        // the length byte is not covered, kept for compatibility
+        uint8_t crc = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t extract = data[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                uint8_t sum = (crc ^ extract) & 0x01;
+                crc >>= 1;
+                if (sum) {
+                    crc ^= 0x8C;
+                }
+                extract >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    uint32_t poly = width == CRC_32 ? 0xEDB88320 : 0x8408;
+    uint32_t mask = width == CRC_32 ? 0xFFFFFFFF : 0xFFFF;
+    uint32_t crc = mask;
+    for (size_t i = 0; i <= count; ++i) {
+        crc ^= i == 0 ? length : data[i - 1];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return ~crc & mask;
+}
+
+// nearest of the 16 codewords: corrects one flipped bit, rejects two
+static int referenceFec(uint8_t code, uint8_t &nibble)
+{
+    int best = -1;
+    int bestDistance = 9;
+    for (uint8_t value = 0; value < 16; ++value) {
+        uint8_t codewords[2];
+        WireFec::encode(value, codewords);
+        int distance = __builtin_popcount(codewords[0] ^ code);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = value;
+        }
+    }
+    if (bestDistance > 1) {
+        return -1;
+    }
+    nibble = best;
+    return bestDistance;
+}
+
+// start, length, payload and CRC, end byte already removed
+static Decoded referencePacket(const std::vector<uint8_t> &packet, bool fec)
+{
+    Decoded decoded;
+    decoded.accepted = false;
+    decoded.correctedBits = 0;
+
+    if (packet.size() < 2 || !isKnownType(packet[0])) {
+        return decoded;
+    }
+    decoded.type = WireFrameType(packet[0] & 0x3F);
+    decoded.crc = WireCrcWidth(packet[0] & 0xC0);
+    uint8_t length = packet[1];
+
+    std::vector<uint8_t> body(packet.begin() + 2, packet.end());
+    if (fec) {
+        if (body.size() % 2) {
+            return decoded;
+        }
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < body.size(); i += 2) {
+            uint8_t low, high;
+            int lowFixed = referenceFec(body[i], low);
+            int highFixed = referenceFec(body[i + 1], high);
+            if (lowFixed < 0 || highFixed < 0) {
+                return decoded;
+            }
+            decoded.correctedBits += lowFixed + highFixed;
+            data.push_back(low | (high << 4));
+        }
+        body = data;
+    }
+
+    uint8_t crcBytes = crcLength(decoded.crc);
+    if (body.size() < crcBytes) {
+        return decoded;
+    }
+    size_t payloadLength = body.size() - crcBytes;
+
+    uint32_t packetCrc = 0;
+    for (uint8_t i = 0; i < crcBytes; ++i) {
+        packetCrc |= uint32_t(body[payloadLength + i]) << (8 * i);
+    }
+    if (packetCrc != referenceCrc(decoded.crc, length, body.data(), payloadLength)) {
+        return decoded;
+    }
+
+    decoded.payload.assign(body.begin(), body.begin() + payloadLength);
+    decoded.accepted = true;
+    return decoded;
+}
+
+static Decoded referenceStx(const std::vector<uint8_t> &frame, bool fec)
+{
+    Decoded rejected;
+    rejected.accepted = false;
+
+    if (frame.size() < 2 || !isKnownType(frame[0])) {
+        return rejected;
+    }
+    uint8_t length = frame[1];
+    uint8_t minimum = 3 + crcLength(WireCrcWidth(frame[0] & 0xC0));
+    if (length < minimum || length > UNPACKER_BUFFER_LENGTH
+            || frame.size() != length || frame[length - 1] != 0x04) {
+        return rejected;
+    }
+
+    std::vector<uint8_t> packet(frame.begin(), frame.end() - 1);
+    return referencePacket(packet, fec);
+}
+
+static Decoded referenceCobs(const std::vector<uint8_t> &frame, bool fec)
+{
+    Decoded rejected;
+    rejected.accepted = false;
+
+    // one delimiter, at the end
+    if (frame.size() < 2 || frame.back() != 0
+            || memchr(frame.data(), 0, frame.size() - 1)
+            || frame.size() - 1 > UNPACKER_BUFFER_LENGTH) {
+        return rejected;
+    }
+
+    std::vector<uint8_t> packet;
+    size_t in = 0;
+    size_t encodedLength = frame.size() - 1;
+    while (in < encodedLength) {
+        uint8_t code = frame[in++];
+        if (in + code - 1 > encodedLength) {
+            return rejected;
+        }
+        packet.insert(packet.end(), frame.begin() + in, frame.begin() + in + code - 1);
+        in += code - 1;
+        if (code < 0xFF && in < encodedLength) {
+            packet.push_back(0);
+        }
+    }
+
+    // the length byte counts the end byte, not sent with COBS
+    if (packet.size() < 3 || packet[1] != packet.size() + 1) {
+        return rejected;
+    }
+    return referencePacket(packet, fec);
+}
+
+
+// WireUnpacker under test
+
+static Decoded unpack(const std::vector<uint8_t> &frame, const Settings &settings)
+{
+    WireUnpacker unpacker;
+    unpacker.setFraming(settings.framing);
+    unpacker.setFec(settings.fec);
+
+    // byte by byte, as TwoWireSlave::processInput(): the packet
+    // must start at the first byte and end at the last one
+    Decoded decoded;
+    decoded.accepted = false;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        unpacker.write(frame[i]);
+        if (unpacker.totalLength() == 0) {
+            break;
+        }
+        if (!unpacker.isPacketOpen()) {
+            decoded.accepted = i == frame.size() - 1 && !unpacker.hasError();
+            break;
+        }
+    }
+    decoded.type = unpacker.frameType();
+    decoded.crc = unpacker.crcWidth();
+    decoded.correctedBits = unpacker.correctedBits();
+    if (decoded.accepted) {
+        // a broken length still gets reported as a mismatch
+        size_t available = unpacker.available();
+        if (available > UNPACKER_BUFFER_LENGTH) {
+            available = UNPACKER_BUFFER_LENGTH;
+        }
+        decoded.payload.assign(unpacker.payload(), unpacker.payload() + available);
+        for (size_t i = 0; i < available; ++i) {
+            if (unpacker.read() != decoded.payload[i]) {
+                decoded.accepted = false;
+            }
+        }
+        if (unpacker.read() != -1) {
+            decoded.accepted = false;
+        }
+    }
+    return decoded;
+}
+
+
+// frames
+
+static Settings randomSettings()
+{
+    Settings settings;
+    settings.type = frameTypes[randomBelow(sizeof(frameTypes))];
+    settings.crc = crcWidths[randomBelow(3)];
+    settings.framing = randomBelow(2) ? FRAMING_COBS : FRAMING_STX;
+    settings.fec = randomBelow(2);
+    return settings;
+}
+
+static std::vector<uint8_t> randomFrame(const Settings &settings, std::vector<uint8_t> &payload)
+{
+    WirePacker packer;
+    packer.setFraming(settings.framing);
+    packer.setFec(settings.fec);
+    packer.setCrc(settings.crc);
+    packer.reset(settings.type);
+
+    size_t length = randomBelow(packer.room() + 1);
+    payload.clear();
+    for (size_t i = 0; i < length; ++i) {
+        // zeros are common, so that COBS has work to do
+        uint8_t data = randomBelow(4) ? random32() : 0;
+        payload.push_back(data);
+        packer.write(data);
+    }
+    packer.end();
+
+    std::vector<uint8_t> frame(packer.available());
+    packer.read(frame.data(), frame.size());
+    return frame;
+}
+
+static void mutate(std::vector<uint8_t> &frame)
+{
+    switch (randomBelow(7)) {
+    case 0: {
+        // one to three flipped bits
+        int flips = 1 + randomBelow(3);
+        for (int i = 0; i < flips && !frame.empty(); ++i) {
+            frame[randomBelow(frame.size())] ^= 1 << randomBelow(8);
+        }
+        break;
+    }
+    case 1:
+        if (!frame.empty()) {
+            frame[randomBelow(frame.size())] = random32();
+        }
+        break;
+    case 2:
+        // length byte, where the underflows used to be
+        if (frame.size() > 2) {
+            frame[frame.back() == 0 ? 2 : 1] = randomBelow(8);
+        }
+        break;
+    case 3:
+        frame.insert(frame.begin() + randomBelow(frame.size() + 1), uint8_t(random32()));
+        break;
+    case 4:
+        if (!frame.empty()) {
+            frame.erase(frame.begin() + randomBelow(frame.size()));
+        }
+        break;
+    case 5:
+        frame.resize(randomBelow(frame.size() + 1));
+        break;
+    default:
+        frame.resize(randomBelow(2 * UNPACKER_BUFFER_LENGTH + 8));
+        for (size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = random32();
+        }
+        break;
+    }
+}
+
+static void printFrame(const char *name, const std::vector<uint8_t> &data)
+{
+    fprintf(stderr, "  %s (%u):", name, (unsigned) data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        fprintf(stderr, " %02X", data[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+static bool sameResult(const Decoded &a, const Decoded &b)
+{
+    if (a.accepted != b.accepted) {
+        return false;
+    }
+    return !a.accepted || (a.type == b.type && a.crc == b.crc
+            && a.correctedBits == b.correctedBits && a.payload == b.payload);
+}
+
+static int runCheck(unsigned long count, unsigned corruptPercent)
+{
+    unsigned long accepted = 0;
+    unsigned long mismatches = 0;
+
+    for (unsigned long n = 0; n < count; ++n) {
+        Settings settings = randomSettings();
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> frame = randomFrame(settings, payload);
+        bool isCorrupt = randomBelow(100) < corruptPercent;
+        if (isCorrupt) {
+            mutate(frame);
+        }
+
+        Decoded expected = settings.framing == FRAMING_COBS
+                ? referenceCobs(frame, settings.fec) : referenceStx(frame, settings.fec);
+        Decoded result = unpack(frame, settings);
+
+        bool failed = !sameResult(expected, result);
+        if (!isCorrupt && (!result.accepted || result.payload != payload
+                || result.type != settings.type || result.crc != settings.crc)) {
+            failed = true;
+        }
+
+        if (failed) {
+            ++mismatches;
+            fprintf(stderr, "frame %lu: %s %s CRC %u%s, reference %s, unpacker %s\n",
+                n, isCorrupt ? "corrupt" : "valid",
+                settings.framing == FRAMING_COBS ? "COBS" : "STX",
+                8u * crcLength(settings.crc), settings.fec ? " FEC" : "",
+                expected.accepted ? "accepts" : "rejects",
+                result.accepted ? "accepts" : "rejects");
+            printFrame("frame", frame);
+            if (mismatches >= 10) {
+                break;
+            }
+        }
+        accepted += result.accepted;
+    }
+
+    printf("%lu frames, %lu accepted, %lu mismatches\n", count, accepted, mismatches);
+    return mismatches ? 1 : 0;
+}
+
+static int runStress(double seconds, unsigned corruptPercent)
+{
+    // one stream per framing and FEC setting, as a slave has one
+    const size_t streamFrames = 4096;
+    unsigned long decoded = 0;
+    unsigned long errors = 0;
+    unsigned long frames = 0;
+    unsigned long bytes = 0;
+    double elapsed = 0;
+
+    while (elapsed < seconds) {
+        Settings settings = randomSettings();
+        std::vector<uint8_t> stream;
+        for (size_t n = 0; n < streamFrames; ++n) {
+            Settings frameSettings = settings;
+            frameSettings.type = frameTypes[randomBelow(sizeof(frameTypes))];
+            frameSettings.crc = crcWidths[randomBelow(3)];
+            std::vector<uint8_t> payload;
+            std::vector<uint8_t> frame = randomFrame(frameSettings, payload);
+            if (randomBelow(100) < corruptPercent) {
+                mutate(frame);
+            }
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+
+        WireUnpacker unpacker;
+        unpacker.setFraming(settings.framing);
+        unpacker.setFec(settings.fec);
+        uint32_t checksum = 0;
+
+        clock_t start = clock();
+        for (size_t i = 0; i < stream.size(); ++i) {
+            if (!unpacker.isPacketOpen()) {
+                unpacker.reset();
+            }
+            unpacker.write(stream[i]);
+            if (!unpacker.isPacketOpen() && unpacker.totalLength() > 0) {
+                if (unpacker.hasError()) {
+                    ++errors;
+                }
+                else {
+                    ++decoded;
+                    checksum += unpacker.available();
+                }
+            }
+        }
+        elapsed += double(clock() - start) / CLOCKS_PER_SEC;
+
+        // keeps the loop from being optimized out
+        if (checksum == 0xFFFFFFFF) {
+            printf(" ");
+        }
+        frames += streamFrames;
+        bytes += stream.size();
+    }
+
+    printf("%lu frames (%u%% corrupt), %lu bytes in %.2f s\n",
+        frames, corruptPercent, bytes, elapsed);
+    printf("  decoded %lu, errors %lu\n", decoded, errors);
+    printf("  %.0f decoded frames/s, %.0f frames/s, %.1f MB/s\n",
+        decoded / elapsed, frames / elapsed, bytes / elapsed / 1e6);
+    return 0;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+        "usage: wire_fuzz [-n frames] [-s seed] [-t seconds] [-c corrupt_percent]\n"
+        "  -n frames    frames to check (100000)\n"
+        "  -s seed      random seed (1)\n"
+        "  -t seconds   stress mode, for at least this decoding time\n"
+        "  -c percent   corrupt frames (check 75, stress 20)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long count = 100000;
+    double seconds = 0;
+    int corruptPercent = -1;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:s:t:c:")) != -1) {
+        switch (option) {
+        case 'n': count = strtoul(optarg, NULL, 10); break;
+        case 's': seed = strtoul(optarg, NULL, 10); break;
+        case 't': seconds = atof(optarg); break;
+        case 'c': corruptPercent = atoi(optarg); break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+
+    if (seed == 0 || corruptPercent > 100) {
+        usage();
+        return 2;
+    }
+
+    if (seconds > 0) {
+        return runStress(seconds, corruptPercent < 0 ? 20 : corruptPercent);
+    }
+    return runCheck(count, corruptPercent < 0 ? 75 : corruptPercent);
+}
@@ -0,0 +1,235 @@
+/**
+ * @file wire_replay.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Replays a WireCapture file on a Linux host
+ * @date 2026-10-18
+ *
+ * Feeds the driver reads of a capture file (see WireCapture.h)
+ * byte by byte to a WireUnpacker, as TwoWireSlave::update() does,
+ * and the driver writes to another one, then prints what was
+ * found. The output only depends on the capture, so it can be
+ * compared against a saved one in a regression test.
+ *
+ * With -n, the reads are replayed that many times as fast as
+ * possible and the unpacking throughput is printed.
+ *
+ * Build from this directory:
+ *      g++ -O2 -I../../src -o wire_replay wire_replay.cpp \
+ *          ../../src/WireUnpacker.cpp ../../src/WireCrc.cpp
+ *
+ * Usage:
+ *      wire_replay [-v] [-n iterations] capture.bin
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "WireCapture.h"
+#include "WireUnpacker.h"
+
+struct Record
+{
+    uint8_t kind;
+    uint32_t time;
+    std::vector<uint8_t> data;
+};
+
+struct Summary
+{
+    unsigned long packets[256];
+    unsigned long errors;
+    unsigned long bytes;
+};
+
+static bool loadCapture(const char *path, std::vector<Record> &records)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    uint8_t header[5];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+            || memcmp(header, "WCAP", 4) != 0
+            || header[4] != WIRECAPTURE_VERSION) {
+        fprintf(stderr, "%s: not a version %d capture file\n", path, WIRECAPTURE_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    uint8_t recordHeader[WIRECAPTURE_RECORD_HEADER];
+    while (fread(recordHeader, 1, sizeof(recordHeader), file) == sizeof(recordHeader)) {
+        Record record;
+        record.kind = recordHeader[0];
+        record.time = recordHeader[1] | (recordHeader[2] << 8)
+                | (recordHeader[3] << 16) | (uint32_t(recordHeader[4]) << 24);
+        record.data.resize(recordHeader[5]);
+
+        if (fread(record.data.data(), 1, record.data.size(), file) != record.data.size()) {
+            fprintf(stderr, "%s: truncated record\n", path);
+            break;
+        }
+        records.push_back(record);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Same packet loop as TwoWireSlave::processInput().
+ */
+static void unpack(WireUnpacker &unpacker, const std::vector<uint8_t> &data,
+        Summary &summary, bool verbose)
+{
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (!unpacker.isPacketOpen()) {
+            unpacker.reset();
+        }
+
+        unpacker.write(data[i]);
+
+        if (unpacker.isPacketOpen() || unpacker.totalLength() == 0) {
+            continue;
+        }
+
+        if (unpacker.hasError()) {
+            ++summary.errors;
+            if (verbose) {
+                printf("  error %d\n", unpacker.lastError());
+            }
+        }
+        else {
+            ++summary.packets[unpacker.frameType()];
+            summary.bytes += unpacker.available();
+            if (verbose) {
+                printf("  packet 0x%02X, %u bytes\n",
+                        unpacker.frameType(), unsigned(unpacker.available()));
+            }
+        }
+    }
+}
+
+static void configure(const Record &record, WireUnpacker &unpacker)
+{
+    if (record.data.size() == 2) {
+        unpacker.setFraming(WireFraming(record.data[0]));
+        unpacker.setFec(record.data[1] != 0);
+    }
+}
+
+static void printSummary(const char *name, const Summary &summary)
+{
+    printf("%s: %lu payload bytes, %lu errors\n", name, summary.bytes, summary.errors);
+    for (int type = 0; type < 256; ++type) {
+        if (summary.packets[type]) {
+            printf("  type 0x%02X: %lu packets\n", type, summary.packets[type]);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool verbose = false;
+    long iterations = 0;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        }
+        else {
+            path = argv[i];
+        }
+    }
+
+    if (!path) {
+        fprintf(stderr, "usage: %s [-v] [-n iterations] capture.bin\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Record> records;
+    if (!loadCapture(path, records)) {
+        return 1;
+    }
+
+    WireUnpacker input;
+    WireUnpacker output;
+    Summary inputSummary = {};
+    Summary outputSummary = {};
+    unsigned long readBytes = 0;
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record &record = records[i];
+
+        if (verbose) {
+            printf("%10u %c %u bytes\n", record.time, record.kind, unsigned(record.data.size()));
+        }
+
+        switch (record.kind) {
+        case WireCapture::CONFIG:
+            configure(record, input);
+            configure(record, output);
+            break;
+        case WireCapture::READ:
+            readBytes += record.data.size();
+            unpack(input, record.data, inputSummary, verbose);
+            break;
+        case WireCapture::WRITE:
+            unpack(output, record.data, outputSummary, verbose);
+            break;
+        case WireCapture::RESET_TX:
+            output.reset();
+            break;
+        default:
+            fprintf(stderr, "unknown record kind 0x%02X\n", record.kind);
+            break;
+        }
+    }
+
+    printf("%u records\n", unsigned(records.size()));
+    printSummary("received", inputSummary);
+    printSummary("sent", outputSummary);
+
+    if (iterations <= 0) {
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long n = 0; n < iterations; ++n) {
+        WireUnpacker unpacker;
+        Summary summary = {};
+
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (records[i].kind == WireCapture::CONFIG) {
+                configure(records[i], unpacker);
+            }
+            else if (records[i].kind == WireCapture::READ) {
+                unpack(unpacker, records[i].data, summary, false);
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double bytes = double(readBytes) * iterations;
+
+    unsigned long packets = inputSummary.errors;
+    for (int type = 0; type < 256; ++type) {
+        packets += inputSummary.packets[type];
+    }
+
+    printf("replayed %ld times in %.3f s: %.1f MB/s, %.0f packets/s\n",
+            iterations, seconds, bytes / seconds / 1e6,
+            double(packets) * iterations / seconds);
+    return 0;
+}
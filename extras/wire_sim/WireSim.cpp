@@ -0,0 +1,417 @@
+/**
+ * @file WireSim.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Virtual I2C bus joining TwoWire and TwoWireSlave on a host
+ * @date 2026-10-18
+ *
+ * Also holds the Arduino core, ESP-IDF and TwoWire functions
+ * declared by the headers in stubs/.
+ *
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <driver/i2c.h>
+#include <esp_ipc.h>
+#include <WireSlave.h>
+
+#include "WireSim.h"
+
+WireSim Sim;
+
+WireSim::WireSim()
+    :nanos_(0)
+{
+    reset();
+}
+
+void WireSim::reset()
+{
+    setClock(100000);
+    setBitErrorRate(0);
+    flipIndex_ = -1;
+    flipMask_ = 0;
+    slaveAddress_ = 4;
+    isGeneralCall_ = false;
+    updatePeriod_ = 1;
+    sinceUpdate_ = 0;
+    isUpdatedOnTransfers_ = false;
+    rxRing_.clear();
+    txRing_.clear();
+    rxCapacity_ = 256;
+    txCapacity_ = 256;
+    memset(pins_, 0, sizeof(pins_));
+    resetCounters();
+}
+
+void WireSim::setClock(uint32_t hz)
+{
+    byteNanos_ = uint32_t(9 * 1000000000ULL / hz);
+}
+
+void WireSim::setBitErrorRate(double rate, uint32_t seed)
+{
+    bitErrorRate_ = rate;
+    seed_ = seed ? seed : 1;
+}
+
+void WireSim::flipNextRead(size_t index, uint8_t mask)
+{
+    flipIndex_ = int(index);
+    flipMask_ = mask;
+}
+
+void WireSim::setSlaveAddress(uint8_t address)
+{
+    slaveAddress_ = address;
+}
+
+void WireSim::advance(uint32_t us)
+{
+    nanos_ += us * 1000ULL;
+}
+
+void WireSim::run(unsigned long ms)
+{
+    while (ms--) {
+        advance(1000);
+        tick();
+    }
+}
+
+void WireSim::tick()
+{
+    if (++sinceUpdate_ >= updatePeriod_) {
+        sinceUpdate_ = 0;
+        WireSlave.update();
+    }
+}
+
+// runs update() at every millisecond boundary crossed
+void WireSim::elapse(uint64_t nanos)
+{
+    uint64_t end = nanos_ + nanos;
+    uint64_t boundary = (nanos_ / 1000000 + 1) * 1000000;
+
+    while (boundary <= end) {
+        nanos_ = boundary;
+        boundary += 1000000;
+        tick();
+    }
+    nanos_ = end;
+}
+
+uint8_t WireSim::masterWrite(uint8_t busNum, uint8_t address,
+        const uint8_t *data, size_t length)
+{
+    ++transactions_;
+
+    if (busNum != 0 || (address != slaveAddress_ && !(address == 0 && isGeneralCall_))) {
+        // address not acknowledged
+        transfer(0);
+        ++nacks_;
+        return 2;
+    }
+
+    transfer(length);
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = corrupt(data[i]);
+        if (rxRing_.size() >= rxCapacity_) {
+            ++overflows_;
+            continue;
+        }
+        rxRing_.push_back(byte);
+    }
+    return 0;
+}
+
+size_t WireSim::masterRead(uint8_t busNum, uint8_t address,
+        uint8_t *data, size_t length)
+{
+    ++transactions_;
+
+    if (busNum != 0 || address != slaveAddress_) {
+        transfer(0);
+        ++nacks_;
+        return 0;
+    }
+
+    transfer(length);
+    for (size_t i = 0; i < length; ++i) {
+        // an empty slave buffer reads as an idle bus
+        uint8_t byte = 0xFF;
+        if (!txRing_.empty()) {
+            byte = txRing_.front();
+            txRing_.pop_front();
+        }
+        if (int(i) == flipIndex_) {
+            byte ^= flipMask_;
+        }
+        data[i] = corrupt(byte);
+    }
+    flipIndex_ = -1;
+
+    return length;
+}
+
+size_t WireSim::slaveRead(uint8_t *data, size_t length, uint32_t waitTicks)
+{
+    // the slave task would block, the bus keeps going
+    if (rxRing_.empty()) {
+        blockedTicks_ += waitTicks;
+    }
+
+    size_t count = 0;
+    while (count < length && !rxRing_.empty()) {
+        data[count++] = rxRing_.front();
+        rxRing_.pop_front();
+    }
+    return count;
+}
+
+int WireSim::slaveWrite(const uint8_t *data, size_t length)
+{
+    // as the driver does, all or nothing
+    if (txRing_.size() + length > txCapacity_) {
+        return 0;
+    }
+    txRing_.insert(txRing_.end(), data, data + length);
+    return int(length);
+}
+
+void WireSim::resetCounters()
+{
+    transactions_ = 0;
+    nacks_ = 0;
+    bytes_ = 0;
+    flippedBits_ = 0;
+    overflows_ = 0;
+    blockedTicks_ = 0;
+}
+
+// bus time of a transaction, address byte included
+void WireSim::transfer(size_t length)
+{
+    bytes_ += length;
+    uint64_t nanos = uint64_t(length + 1) * byteNanos_;
+    if (isUpdatedOnTransfers_) {
+        elapse(nanos);
+    }
+    else {
+        nanos_ += nanos;
+    }
+}
+
+uint8_t WireSim::corrupt(uint8_t data)
+{
+    if (bitErrorRate_ <= 0) {
+        return data;
+    }
+
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+        if (random() < bitErrorRate_ * 4294967296.0) {
+            data ^= 1 << bit;
+            ++flippedBits_;
+        }
+    }
+    return data;
+}
+
+// xorshift32, so that runs are repeatable
+uint32_t WireSim::random()
+{
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
+
+// Arduino core
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t data)
+{
+    return fputc(data, stdout) == EOF ? 0 : 1;
+}
+
+unsigned long millis()
+{
+    return (unsigned long) (Sim.nanos() / 1000000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long) (Sim.nanos() / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    Sim.run(ms);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    Sim.advance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    Sim.setPin(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Sim.pin(pin);
+}
+
+
+// ESP-IDF
+
+int xPortGetCoreID()
+{
+    return 0;
+}
+
+esp_err_t esp_ipc_call_blocking(uint32_t core, esp_ipc_func_t function, void *arg)
+{
+    function(arg);
+    return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config)
+{
+    Sim.setSlaveAddress(config->slave.slave_addr);
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+        size_t rxLength, size_t txLength, int intrAllocFlags)
+{
+    Sim.setRxCapacity(rxLength);
+    Sim.setTxCapacity(txLength);
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port)
+{
+    return ESP_OK;
+}
+
+int i2c_slave_read_buffer(i2c_port_t port, uint8_t *data, size_t length, TickType_t wait)
+{
+    return int(Sim.slaveRead(data, length, wait));
+}
+
+int i2c_slave_write_buffer(i2c_port_t port, const uint8_t *data, int length, TickType_t wait)
+{
+    return Sim.slaveWrite(data, length);
+}
+
+// like the real driver, only the hardware FIFO is reset: bytes
+// already in the driver ring buffer stay there
+esp_err_t i2c_reset_tx_fifo(i2c_port_t port)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_reset_rx_fifo(i2c_port_t port)
+{
+    return ESP_OK;
+}
+
+
+// TwoWire
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+TwoWire::TwoWire(uint8_t busNum)
+    :busNum_(busNum)
+    ,address_(0)
+    ,txLength_(0)
+    ,rxLength_(0)
+    ,rxIndex_(0)
+{
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    if (frequency) {
+        setClock(frequency);
+    }
+    return true;
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+    Sim.setClock(frequency);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    address_ = address;
+    txLength_ = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    return Sim.masterWrite(busNum_, address_, txBuffer_, txLength_);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+    if (quantity > sizeof(rxBuffer_)) {
+        quantity = sizeof(rxBuffer_);
+    }
+    rxLength_ = Sim.masterRead(busNum_, address, rxBuffer_, quantity);
+    rxIndex_ = 0;
+    return uint8_t(rxLength_);
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (txLength_ >= sizeof(txBuffer_)) {
+        return 0;
+    }
+    txBuffer_[txLength_++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    size_t count = 0;
+    while (count < length && write(data[count])) {
+        ++count;
+    }
+    return count;
+}
+
+int TwoWire::available()
+{
+    return int(rxLength_ - rxIndex_);
+}
+
+int TwoWire::read()
+{
+    if (rxIndex_ >= rxLength_) {
+        return -1;
+    }
+    return rxBuffer_[rxIndex_++];
+}
+
+int TwoWire::peek()
+{
+    if (rxIndex_ >= rxLength_) {
+        return -1;
+    }
+    return rxBuffer_[rxIndex_];
+}
+
+void TwoWire::flush()
+{
+}
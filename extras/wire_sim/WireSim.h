@@ -0,0 +1,154 @@
+/**
+ * @file WireSim.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Virtual I2C bus joining TwoWire and TwoWireSlave on a host
+ * @date 2026-10-18
+ *
+ * The master side (Wire, see stubs/Wire.h) and the slave driver
+ * calls of TwoWireSlave (see stubs/driver/i2c.h) both end here, so
+ * the whole library runs unchanged on a PC. Time is simulated:
+ * bus transfers take as long as they would at the set clock rate,
+ * and delay() runs WireSlave.update() once per millisecond, as the
+ * slave task would.
+ *
+ */
+#ifndef WireSim_h
+#define WireSim_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+
+class WireSim
+{
+public:
+    WireSim();
+
+    /**
+     * Puts the bus back to its initial state: 100 kHz, no bit
+     * errors, slave at address 4 without general call, updated
+     * every millisecond of delay(), empty driver buffers, zeroed
+     * counters.
+     * The simulated time keeps running.
+     */
+    void reset();
+
+    /**
+     * Bus clock rate, in Hz. Each byte takes 9 clock periods,
+     * and each transaction one byte more for the address.
+     */
+    void setClock(uint32_t hz);
+
+    /**
+     * Flips each bit moved on the bus with the given probability.
+     * Errors are pseudo-random, but the same for the same seed.
+     */
+    void setBitErrorRate(double rate, uint32_t seed = 1);
+
+    /**
+     * Flips bits of one byte of the next master read, for tests
+     * that need an error at a known place.
+     *
+     * @param index     byte of the read to be corrupted
+     * @param mask      bits to flip
+     */
+    void flipNextRead(size_t index, uint8_t mask = 0x10);
+
+    // address the slave answers to
+    void setSlaveAddress(uint8_t address);
+    uint8_t slaveAddress() const { return slaveAddress_; }
+
+    /**
+     * Whether the slave also receives writes to address 0. Off by
+     * default, as on the classic ESP32; see
+     * TwoWireSlaveConfig::generalCall.
+     */
+    void setGeneralCall(bool enabled) { isGeneralCall_ = enabled; }
+
+    // simulated time since start
+    uint64_t nanos() const { return nanos_; }
+    void advance(uint32_t us);
+
+    /**
+     * Advances the time by the given milliseconds, running
+     * WireSlave.update() every update period.
+     */
+    void run(unsigned long ms);
+
+    // milliseconds between WireSlave.update() calls, 1 by default
+    void setUpdatePeriod(uint32_t ms) { updatePeriod_ = ms ? ms : 1; }
+
+    /**
+     * Whether update() also runs while a master transaction takes
+     * the bus, as the slave task would, instead of only in delay().
+     * Off by default: the phase of update() then shifts with every
+     * transaction, which blurs timings such as WireTimeSync's.
+     */
+    void setUpdatedOnTransfers(bool enabled) { isUpdatedOnTransfers_ = enabled; }
+
+    // master side, called by TwoWire
+    uint8_t masterWrite(uint8_t busNum, uint8_t address, const uint8_t *data, size_t length);
+    size_t masterRead(uint8_t busNum, uint8_t address, uint8_t *data, size_t length);
+
+    // slave side, called by the driver stand-in
+    void setRxCapacity(size_t length) { rxCapacity_ = length; }
+    void setTxCapacity(size_t length) { txCapacity_ = length; }
+    size_t slaveRead(uint8_t *data, size_t length, uint32_t waitTicks);
+    int slaveWrite(const uint8_t *data, size_t length);
+
+    // bytes the slave has queued and the master has not read yet
+    size_t txPending() const { return txRing_.size(); }
+    void clearTx() { txRing_.clear(); }
+
+    // output pins of the slave, as set by digitalWrite()
+    void setPin(uint8_t pin, uint8_t level) { pins_[pin % PIN_COUNT] = level; }
+    uint8_t pin(uint8_t pin) const { return pins_[pin % PIN_COUNT]; }
+
+    uint32_t transactionCount() const { return transactions_; }
+    uint32_t nackCount() const { return nacks_; }
+    uint32_t byteCount() const { return bytes_; }
+    uint32_t flippedBitCount() const { return flippedBits_; }
+
+    // bytes lost because the slave RX ring was full
+    uint32_t overflowCount() const { return overflows_; }
+
+    // ticks update() spent waiting on an empty RX ring
+    uint32_t blockedTicks() const { return blockedTicks_; }
+    void resetCounters();
+
+    static const uint8_t PIN_COUNT = 64;
+
+private:
+    void transfer(size_t length);
+    void tick();
+    void elapse(uint64_t nanos);
+    uint8_t corrupt(uint8_t data);
+    uint32_t random();
+
+    uint64_t nanos_;
+    uint32_t byteNanos_;
+    double bitErrorRate_;
+    uint32_t seed_;
+    int flipIndex_;
+    uint8_t flipMask_;
+    uint8_t slaveAddress_;
+    bool isGeneralCall_;
+    uint32_t updatePeriod_;
+    uint32_t sinceUpdate_;
+    bool isUpdatedOnTransfers_;
+    std::deque<uint8_t> rxRing_;
+    std::deque<uint8_t> txRing_;
+    size_t rxCapacity_;
+    size_t txCapacity_;
+    uint8_t pins_[PIN_COUNT];
+    uint32_t transactions_;
+    uint32_t nacks_;
+    uint32_t bytes_;
+    uint32_t flippedBits_;
+    uint32_t overflows_;
+    uint32_t blockedTicks_;
+};
+
+extern WireSim Sim;
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file Arduino.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the Arduino core for wire_sim
+ * @date 2026-10-18
+ *
+ * Only what the library uses. Time and pins are simulated by
+ * WireSim (see ../WireSim.h).
+ *
+ */
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include "Print.h"
+#include "Stream.h"
+#include "esp_err.h"
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+#define log_e(...) do {} while (0)
+#define log_w(...) do {} while (0)
+#define log_d(...) do {} while (0)
+
+class String
+{
+public:
+    String(const char *text)
+        :text_(text)
+    {
+    }
+
+    const char *c_str() const
+    {
+        return text_;
+    }
+
+private:
+    const char *text_;
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t data);
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    void flush() {}
+};
+
+extern HardwareSerial Serial;
+
+#endif
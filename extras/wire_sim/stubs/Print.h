@@ -0,0 +1,81 @@
+/**
+ * @file Print.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the Arduino Print class for wire_sim
+ * @date 2026-10-18
+ *
+ */
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t data) = 0;
+
+    virtual size_t write(const uint8_t *data, size_t length)
+    {
+        size_t count = 0;
+        while (length-- && write(*data++)) {
+            ++count;
+        }
+        return count;
+    }
+
+    size_t write(const char *text)
+    {
+        return write((const uint8_t *) text, strlen(text));
+    }
+
+    size_t print(const char *text)
+    {
+        return write(text);
+    }
+
+    size_t print(char c)
+    {
+        return write((uint8_t) c);
+    }
+
+    size_t print(long value)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", value);
+        return write(text);
+    }
+
+    size_t print(int value)
+    {
+        return print((long) value);
+    }
+
+    size_t println(const char *text = "")
+    {
+        return print(text) + write("\r\n");
+    }
+
+    size_t println(int value)
+    {
+        return print(value) + write("\r\n");
+    }
+
+    size_t printf(const char *format, ...)
+    {
+        char text[64];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        return write(text);
+    }
+};
+
+#endif
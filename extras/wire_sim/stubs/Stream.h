@@ -0,0 +1,22 @@
+/**
+ * @file Stream.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the Arduino Stream class for wire_sim
+ * @date 2026-10-18
+ *
+ */
+#ifndef Stream_h
+#define Stream_h
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+};
+
+#endif
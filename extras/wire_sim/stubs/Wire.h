@@ -0,0 +1,50 @@
+/**
+ * @file Wire.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the Arduino TwoWire master for wire_sim
+ * @date 2026-10-18
+ *
+ * Transactions go to the virtual bus of WireSim (see ../WireSim.h).
+ * Wire and Wire1 are two separate buses; the simulated slave
+ * (WireSlave) is on Wire.
+ *
+ */
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include "Arduino.h"
+
+class TwoWire : public Stream
+{
+public:
+    TwoWire(uint8_t busNum);
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void setClock(uint32_t frequency);
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t length);
+    using Print::write;
+    int available();
+    int read();
+    int peek();
+    void flush();
+
+private:
+    uint8_t busNum_;
+    uint8_t address_;
+    uint8_t txBuffer_[128];
+    size_t txLength_;
+    uint8_t rxBuffer_[128];
+    size_t rxLength_;
+    size_t rxIndex_;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
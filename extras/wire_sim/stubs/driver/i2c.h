@@ -0,0 +1,52 @@
+/**
+ * @file i2c.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the ESP-IDF I2C driver for wire_sim
+ * @date 2026-10-18
+ *
+ * The slave calls are served by the virtual bus of WireSim
+ * (see ../../WireSim.h).
+ *
+ */
+#ifndef driver_i2c_h
+#define driver_i2c_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int i2c_port_t;
+typedef int gpio_num_t;
+typedef int gpio_pullup_t;
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER,
+} i2c_mode_t;
+
+#define GPIO_PULLUP_DISABLE 0
+#define GPIO_PULLUP_ENABLE 1
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    gpio_pullup_t sda_pullup_en;
+    int scl_io_num;
+    gpio_pullup_t scl_pullup_en;
+    struct {
+        uint8_t addr_10bit_en;
+        uint16_t slave_addr;
+    } slave;
+} i2c_config_t;
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+        size_t rxLength, size_t txLength, int intrAllocFlags);
+esp_err_t i2c_driver_delete(i2c_port_t port);
+int i2c_slave_read_buffer(i2c_port_t port, uint8_t *data, size_t length, TickType_t wait);
+int i2c_slave_write_buffer(i2c_port_t port, const uint8_t *data, int length, TickType_t wait);
+esp_err_t i2c_reset_tx_fifo(i2c_port_t port);
+esp_err_t i2c_reset_rx_fifo(i2c_port_t port);
+
+#endif
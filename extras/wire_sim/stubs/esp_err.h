@@ -0,0 +1,18 @@
+/**
+ * @file esp_err.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of ESP-IDF error codes for wire_sim
+ * @date 2026-10-18
+ *
+ */
+#ifndef esp_err_h
+#define esp_err_h
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+#endif
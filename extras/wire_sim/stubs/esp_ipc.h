@@ -0,0 +1,18 @@
+/**
+ * @file esp_ipc.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of ESP-IDF inter-processor calls for wire_sim
+ * @date 2026-10-18
+ *
+ */
+#ifndef esp_ipc_h
+#define esp_ipc_h
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef void (*esp_ipc_func_t)(void *arg);
+
+esp_err_t esp_ipc_call_blocking(uint32_t core, esp_ipc_func_t function, void *arg);
+
+#endif
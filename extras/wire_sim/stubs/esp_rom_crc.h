@@ -0,0 +1,40 @@
+/**
+ * @file esp_rom_crc.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the ESP32 ROM CRC routines for wire_sim
+ * @date 2026-10-18
+ *
+ * Bit by bit, so the simulation also checks the lookup tables
+ * of WireCrc.cpp against an independent implementation.
+ *
+ */
+#ifndef esp_rom_crc_h
+#define esp_rom_crc_h
+
+#include <stdint.h>
+
+static inline uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ * @file FreeRTOS.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the FreeRTOS types for wire_sim
+ * @date 2026-10-18
+ *
+ */
+#ifndef FreeRTOS_h
+#define FreeRTOS_h
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY 0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) (ms)
+
+int xPortGetCoreID();
+
+#endif
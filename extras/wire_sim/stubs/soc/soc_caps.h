@@ -0,0 +1,16 @@
+/**
+ * @file soc_caps.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Host stand-in of the ESP-IDF chip capabilities for wire_sim
+ * @date 2026-10-18
+ *
+ * Simulates a classic ESP32: no general call support in the
+ * slave peripheral.
+ *
+ */
+#ifndef soc_caps_h
+#define soc_caps_h
+
+#define SOC_I2C_NUM 2
+
+#endif
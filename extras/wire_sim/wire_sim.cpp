@@ -0,0 +1,1203 @@
+/**
+ * @file wire_sim.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Runs the library against a simulated I2C bus on a Linux host
+ * @date 2026-10-18
+ *
+ * The slave (WireSlave) and the master classes run unchanged, joined
+ * by the virtual bus of WireSim.h. With no options, runs a scenario
+ * for each feature, prints each failed check and exits with the
+ * number of failures. With -n, makes that many requests and writes
+ * at the given clock rate and bit error rate instead, and reports
+ * how many went through, how many were retried or corrected, and
+ * whether a corrupted packet was ever accepted. The slave driver
+ * settings of TwoWireSlaveConfig can be set for the load run, to
+ * see what they change.
+ *
+ * Build from this directory:
+ *      g++ -std=gnu++11 -g -fsanitize=address,undefined \
+ *          -DARDUINO=10800 -DARDUINO_ARCH_ESP32 -Istubs -I../../src \
+ *          -o wire_sim wire_sim.cpp WireSim.cpp ../../src/Wire*.cpp
+ *
+ * Usage:
+ *      wire_sim [-n count] [-c clock] [-e bit_error_rate] [-s seed]
+ *               [-l length] [-k crc_width] [-f] [-x]
+ *               [-r ring_length] [-p update_period] [-b read_timeout]
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <WireSlave.h>
+#include <WireSlaveRequest.h>
+#include <WireSlaveWrite.h>
+#include <WireScanner.h>
+#include <WireDelta.h>
+#include <WireBulkWrite.h>
+#include <WireCapture.h>
+#include <WireTimeSync.h>
+#include <WireNotifier.h>
+#include <WireSweep.h>
+#include <WireQueue.h>
+#include <WirePacketPool.h>
+#include <WireMessage.h>
+
+#include "WireSim.h"
+
+#define SLAVE_ADDR 4
+#define MISSING_ADDR 5
+#define DATA_READY_PIN 9
+
+static int failures = 0;
+
+#define CHECK(condition) check(condition, #condition, __LINE__)
+
+static void check(bool passed, const char *text, int line)
+{
+    if (!passed) {
+        fprintf(stderr, "wire_sim.cpp:%d: failed: %s\n", line, text);
+        ++failures;
+    }
+}
+
+// slave side
+
+static int received = -1;
+static uint8_t receivedEndpoint = 0;
+static bool receivedBroadcast = false;
+static uint8_t receivedData[200];
+
+static void onReceive(int count)
+{
+    received = count;
+    receivedEndpoint = WireSlave.endpoint();
+    receivedBroadcast = WireSlave.isBroadcast();
+    for (int i = 0; i < count; ++i) {
+        receivedData[i] = WireSlave.read();
+    }
+}
+
+static void onRequest()
+{
+    WireSlave.print("hello");
+}
+
+static void onRequestEndpoint()
+{
+    WireSlave.print("ep2");
+}
+
+static void onRequestFormatted()
+{
+    WireSlave.printf("t=%d ", 7);
+    WireSlave.writeFixed(-215, 1);
+    WireSlave.write(' ');
+    WireSlave.writeFloat(1.5);
+}
+
+static uint8_t state[DELTA_SNAPSHOT_LENGTH];
+static size_t stateLength = 100;
+
+static void onRequestState()
+{
+    WireSlave.write(state, stateLength);
+}
+
+#define IMAGE_LENGTH 5000
+
+static uint8_t image[IMAGE_LENGTH];
+static uint8_t stored[IMAGE_LENGTH];
+static int chunkCalls = 0;
+static int refuseEvery = 0;
+
+static bool onChunk(uint32_t offset, const uint8_t *data, size_t length)
+{
+    ++chunkCalls;
+    if (refuseEvery && chunkCalls % refuseEvery == 0) {
+        return false;
+    }
+    CHECK(offset + length <= IMAGE_LENGTH);
+    memcpy(stored + offset, data, length);
+    return true;
+}
+
+static size_t imageSource(uint32_t offset, uint8_t *buffer, size_t length)
+{
+    memcpy(buffer, image + offset, length);
+    return length;
+}
+
+// master side
+
+static void sendPacket(WirePacker &packer)
+{
+    packer.end();
+    Wire.beginTransmission(SLAVE_ADDR);
+    while (packer.available()) {
+        Wire.write(packer.read());
+    }
+    Wire.endTransmission();
+    delay(2);
+}
+
+// master clock running slower than the slave's, and 5 s behind
+class SkewTransport : public TwoWireTransport
+{
+public:
+    uint32_t micros()
+    {
+        return uint32_t(::micros() * 0.9999) - 5000000u;
+    }
+};
+
+// slave that takes 8 ms to have its answer ready
+class LagTransport : public WireTransport
+{
+public:
+    bool write(uint8_t address, const uint8_t *data, size_t length)
+    {
+        if (address != SLAVE_ADDR) {
+            return false;
+        }
+        writtenAt_ = ::micros();
+        return true;
+    }
+
+    size_t read(uint8_t address, uint8_t *data, size_t length)
+    {
+        if (address != SLAVE_ADDR) {
+            return 0;
+        }
+        memset(data, 0xFF, length);
+        if (::micros() - writtenAt_ >= 8000) {
+            WirePacker packer;
+            packer.write("hello");
+            packer.end();
+            packer.read(data, length);
+        }
+        return length;
+    }
+
+    void delay(unsigned long ms)
+    {
+        ::delay(ms);
+    }
+
+    uint32_t micros()
+    {
+        return ::micros();
+    }
+
+private:
+    uint32_t writtenAt_ = 0;
+};
+
+// scenarios
+
+static void testRequest()
+{
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    CHECK(request.request());
+    CHECK(request.available() == 5);
+    CHECK(request.read() == 'h');
+
+    WireSlaveRequest missing(Wire, MISSING_ADDR, 32);
+    CHECK(!missing.request());
+    CHECK(missing.lastStatus() == WireSlaveRequest::SLAVE_NOT_FOUND);
+
+    // without a retry delay, a slow slave is still waited for
+    Sim.setUpdatePeriod(4);
+    WireSlaveRequest quick(Wire, SLAVE_ADDR, 32);
+    quick.setRetryDelay(0);
+    CHECK(quick.request());
+    CHECK(quick.available() == 5);
+    Sim.setUpdatePeriod(1);
+    Sim.clearTx();
+}
+
+static void testPool()
+{
+    WirePacketPool &pool = WirePacketPool::shared();
+    uint8_t used = pool.inUse();
+
+    // a payload read to the end holds no block
+    WireSlaveRequest first(Wire, SLAVE_ADDR, 32);
+    CHECK(first.request());
+    while (first.available()) {
+        first.read();
+    }
+    CHECK(pool.inUse() == used);
+
+    // more responses held than blocks, copied out
+    WireSlaveRequest r1(Wire, SLAVE_ADDR, 32), r2(Wire, SLAVE_ADDR, 32),
+        r3(Wire, SLAVE_ADDR, 32), r4(Wire, SLAVE_ADDR, 32),
+        r5(Wire, SLAVE_ADDR, 32), r6(Wire, SLAVE_ADDR, 32);
+    WireSlaveRequest *held[] = { &r1, &r2, &r3, &r4, &r5, &r6 };
+    uint8_t buffers[6][32];
+    CHECK(6 > WIREPOOL_SHARED_BLOCKS);
+
+    for (int i = 0; i < 6; ++i) {
+        held[i]->setResponseBuffer(buffers[i], sizeof(buffers[i]));
+        CHECK(held[i]->request());
+        CHECK(pool.inUse() == used);
+    }
+    for (int i = 0; i < 6; ++i) {
+        CHECK(held[i]->available() == 5 && held[i]->read() == 'h');
+        CHECK(held[i]->takeHandle() == WIREPOOL_NO_HANDLE);
+    }
+
+    // a buffer too short for the response
+    uint8_t small[4];
+    r1.setResponseBuffer(small, sizeof(small));
+    CHECK(!r1.request());
+    CHECK(r1.lastStatus() == WireSlaveRequest::PACKET_ERROR);
+    CHECK(pool.inUse() == used);
+}
+
+static void testReceive()
+{
+    WirePacker packer;
+    packer.write("abc");
+    sendPacket(packer);
+    CHECK(received == 3 && receivedData[0] == 'a');
+}
+
+static void testStream(WireFraming framing, size_t length)
+{
+    static uint8_t data[1000];
+    for (int i = 0; i < 1000; ++i) {
+        data[i] = i * 7;
+    }
+
+    WireSlave.setFraming(framing);
+    WireSlave.stream(data, length);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setFraming(framing);
+    request.beginStream();
+    size_t total = 0;
+    bool matches = true;
+    while (request.readStream()) {
+        while (request.available()) {
+            matches &= request.read() == data[total % 1000];
+            ++total;
+        }
+    }
+    CHECK(total == length && matches);
+    CHECK(request.lastStatus() == WireSlaveRequest::STREAM_END);
+
+    WireSlave.setFraming(FRAMING_STX);
+    Sim.clearTx();
+}
+
+static void testBulk()
+{
+    for (int i = 0; i < IMAGE_LENGTH; ++i) {
+        image[i] = i * 13 + 7;
+    }
+    WireSlave.onChunk(onChunk);
+
+    WireSlave.setChunkOffset(0);
+    WireBulkWrite bulk(Wire, SLAVE_ADDR);
+    CHECK(bulk.send(image, IMAGE_LENGTH));
+    CHECK(!memcmp(image, stored, IMAGE_LENGTH));
+    CHECK(WireSlave.chunkOffset() == IMAGE_LENGTH);
+
+    // with the slave running during transfers, answers are ready
+    // when read and the bus never waits: 765 ms with stop-and-wait
+    // windows of 2 chunks
+    Sim.setUpdatedOnTransfers(true);
+    WireSlave.setChunkOffset(0);
+    memset(stored, 0, IMAGE_LENGTH);
+    Sim.resetCounters();
+    unsigned long start = millis();
+    CHECK(bulk.send(image, IMAGE_LENGTH));
+    CHECK(millis() - start < 600);
+    CHECK(!memcmp(image, stored, IMAGE_LENGTH) && Sim.overflowCount() == 0);
+
+    // and go back after a refused chunk, with one still in flight
+    WireSlave.setChunkOffset(0);
+    memset(stored, 0, IMAGE_LENGTH);
+    refuseEvery = 5;
+    CHECK(bulk.send(image, IMAGE_LENGTH));
+    CHECK(!memcmp(image, stored, IMAGE_LENGTH) && Sim.overflowCount() == 0);
+    refuseEvery = 0;
+    Sim.setUpdatedOnTransfers(false);
+
+    // refused chunks are sent again
+    WireSlave.setChunkOffset(0);
+    memset(stored, 0, IMAGE_LENGTH);
+    refuseEvery = 7;
+    WireBulkWrite refused(Wire, SLAVE_ADDR);
+    refused.setWindow(4);
+    // so that 4 chunks fit the 256 byte slave RX ring
+    refused.setChunkLength(48);
+    CHECK(refused.send(imageSource, IMAGE_LENGTH));
+    CHECK(!memcmp(image, stored, IMAGE_LENGTH));
+    refuseEvery = 0;
+
+    // resumed from where the slave is
+    WireSlave.setChunkOffset(3000);
+    memset(stored, 0, IMAGE_LENGTH);
+    WireSlave.setFec(true);
+    WireBulkWrite resumed(Wire, SLAVE_ADDR);
+    resumed.setFec(true);
+    CHECK(resumed.send(image, IMAGE_LENGTH));
+    CHECK(!memcmp(image + 3000, stored + 3000, 2000) && stored[0] == 0);
+    WireSlave.setFec(false);
+
+    WireSlave.setFraming(FRAMING_COBS);
+    WireSlave.setChunkOffset(0);
+    WireBulkWrite cobs(Wire, SLAVE_ADDR);
+    cobs.setFraming(FRAMING_COBS);
+    CHECK(cobs.send(image, IMAGE_LENGTH));
+    CHECK(!memcmp(image, stored, IMAGE_LENGTH));
+    WireSlave.setFraming(FRAMING_STX);
+
+    WireBulkWrite missing(Wire, MISSING_ADDR);
+    CHECK(!missing.send(image, 10));
+    CHECK(missing.lastStatus() == WireBulkWrite::SLAVE_NOT_FOUND);
+
+    Sim.clearTx();
+}
+
+static void testTimeSync()
+{
+    SkewTransport transport;
+    WireTimeSync sync(transport, SLAVE_ADDR);
+    for (int i = 0; i < 4; ++i) {
+        CHECK(sync.sync());
+        delay(1000);
+    }
+    CHECK(WireSlave.isSynced());
+    CHECK(WireSlave.syncDrift() > 80 && WireSlave.syncDrift() < 120);
+
+    delay(2000);
+    int32_t error = int32_t(WireSlave.masterTime() - transport.micros());
+    CHECK(error > -1500 && error < 1500);
+
+    WireSlave.setTimestamps(true);
+    WireSlaveRequest request(transport, SLAVE_ADDR, 32);
+    request.setTimestamps(true);
+    CHECK(request.request());
+    CHECK(request.available() == 5 && request.read() == 'h');
+    int32_t latency = int32_t(request.receivedAt() - request.generatedAt());
+    CHECK(latency > -2000 && latency < 15000);
+    WireSlave.setTimestamps(false);
+    Sim.clearTx();
+
+    WireTimeSync missing(transport, MISSING_ADDR);
+    CHECK(!missing.sync());
+    CHECK(missing.lastStatus() == WireTimeSync::SLAVE_NOT_FOUND);
+
+    // same clock on both sides through TwoWire
+    WireTimeSync plain(Wire, SLAVE_ADDR);
+    CHECK(plain.sync());
+    CHECK(plain.offset() > -2000 && plain.offset() < 2000);
+}
+
+static void testDelta()
+{
+    WireDeltaEncoder encoder;
+    WireDeltaDecoder decoder;
+    WireSlave.setDelta(&encoder);
+    WireSlave.onRequest(onRequestState);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setDelta(&decoder);
+
+    for (int i = 0; i < 100; ++i) {
+        state[i] = i;
+    }
+    for (int k = 0; k < 20; ++k) {
+        state[k * 3 % 100] ^= k + 1;
+        CHECK(request.request());
+        CHECK(request.available() == 100);
+        bool matches = true;
+        for (int i = 0; i < 100; ++i) {
+            matches &= request.read() == state[i];
+        }
+        CHECK(matches);
+    }
+
+    // slave restarted: a full snapshot again
+    WireDeltaEncoder restarted;
+    WireSlave.setDelta(&restarted);
+    state[50] = 1;
+    CHECK(request.request());
+    bool matches = true;
+    for (int i = 0; i < 100; ++i) {
+        matches &= request.read() == state[i];
+    }
+    CHECK(matches);
+
+    // the longest snapshot that fits a packet with CRC8 and STX
+    stateLength = DELTA_SNAPSHOT_LENGTH;
+    WireSlaveRequest longest(Wire, SLAVE_ADDR, 128);
+    WireDeltaDecoder longestDecoder;
+    longest.setDelta(&longestDecoder);
+    CHECK(longest.request());
+    CHECK(longest.available() == DELTA_SNAPSHOT_LENGTH);
+
+    // the CRC16 takes one more byte: the snapshot is refused, not cut
+    WireSlave.setCrc(CRC_16);
+    longest.setCrc(CRC_16);
+    CHECK(!longest.request());
+    CHECK(longest.lastStatus() == WireSlaveRequest::PACKET_ERROR);
+    stateLength = DELTA_SNAPSHOT_LENGTH - 1;
+    CHECK(longest.request());
+    CHECK(longest.available() == DELTA_SNAPSHOT_LENGTH - 1);
+    WireSlave.setCrc(CRC_8);
+    stateLength = 100;
+
+    WireSlave.setDelta(nullptr);
+    WireSlave.onRequest(onRequest);
+    Sim.clearTx();
+}
+
+static void testEndpoints()
+{
+    WireSlave.onRequest(2, onRequestEndpoint);
+    WireSlave.onReceive(3, onReceive);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setEndpoint(2);
+    CHECK(request.request());
+    CHECK(request.available() == 3 && request.read() == 'e');
+
+    WirePacker packer;
+    packer.write(3);
+    packer.write("xy");
+    sendPacket(packer);
+    CHECK(received == 2 && receivedEndpoint == 3 && receivedData[0] == 'x');
+}
+
+static void testSlaveWrite()
+{
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.write(3);
+    write.print("ok");
+    CHECK(write.send());
+    CHECK(received == 2 && receivedEndpoint == 3 && receivedData[0] == 'o');
+
+    // no callback on endpoint 7
+    WireSlaveWrite unknown(Wire, SLAVE_ADDR);
+    unknown.write(7);
+    unknown.print("ok");
+    CHECK(!unknown.send());
+    CHECK(unknown.lastStatus() == WireSlaveWrite::NOT_ACKNOWLEDGED);
+
+    // an ACK left in the slave buffer does not acknowledge the
+    // next packet, NAKed because of its unknown endpoint
+    WirePacker acknowledged;
+    acknowledged.reset(FRAME_WRITE);
+    acknowledged.write(3);
+    sendPacket(acknowledged);
+    CHECK(Sim.txPending() > 0);
+    WireSlaveWrite refused(Wire, SLAVE_ADDR);
+    refused.write(7);
+    refused.setAttempts(1);
+    CHECK(!refused.send());
+    CHECK(refused.lastStatus() == WireSlaveWrite::NOT_ACKNOWLEDGED);
+    Sim.clearTx();
+
+    // failed writes are retried after the same delays as answers
+    WireSlaveWrite missing(Wire, MISSING_ADDR);
+    missing.write(3);
+    unsigned long start = millis();
+    CHECK(!missing.send());
+    CHECK(missing.lastStatus() == WireSlaveWrite::SLAVE_NOT_FOUND);
+    CHECK(millis() - start >= 10 + 20 + 30 + 40);
+
+    // an ACK left in the slave buffer does not break a request
+    WirePacker packer;
+    packer.reset(FRAME_WRITE);
+    packer.write(3);
+    sendPacket(packer);
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    CHECK(request.request());
+    CHECK(request.available() == 5);
+    Sim.clearTx();
+}
+
+static void testCobs()
+{
+    WireSlave.setFraming(FRAMING_COBS);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setFraming(FRAMING_COBS);
+    CHECK(request.request());
+    CHECK(request.available() == 5 && request.read() == 'h');
+
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.setFraming(FRAMING_COBS);
+    write.write(3);
+    write.write(0);
+    write.print("ok");
+    CHECK(write.send());
+    CHECK(received == 3 && receivedEndpoint == 3 && receivedData[0] == 0);
+
+    // a FRAME_WRITE with a broken length after a request is still NAKed
+    Sim.clearTx();
+    CHECK(request.request());
+    WirePacker broken;
+    broken.setFraming(FRAMING_COBS);
+    broken.reset(FRAME_WRITE);
+    broken.write(3);
+    broken.end();
+    uint8_t packet[PACKER_BUFFER_LENGTH];
+    size_t length = broken.read(packet, sizeof(packet));
+    packet[2] ^= 0x01;
+    Wire.beginTransmission(SLAVE_ADDR);
+    Wire.write(packet, length);
+    Wire.endTransmission();
+    delay(2);
+    WireUnpacker answer;
+    answer.setFraming(FRAMING_COBS);
+    Wire.requestFrom(SLAVE_ADDR, uint8_t(Sim.txPending()));
+    while (Wire.available()) {
+        answer.write(Wire.read());
+    }
+    CHECK(answer.totalLength() > 0 && answer.frameType() == FRAME_NAK);
+
+    WireSlave.setFraming(FRAMING_STX);
+    Sim.clearTx();
+}
+
+static void testFec()
+{
+    WireSlave.setFec(true);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setFec(true);
+    Sim.flipNextRead(5);
+    CHECK(request.request());
+    CHECK(request.available() == 5 && request.read() == 'h');
+    CHECK(request.correctedCount() == 1 && request.retryCount() == 0);
+    Sim.clearTx();
+
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.setFec(true);
+    write.write(3);
+    write.print("fe");
+    CHECK(write.send());
+    CHECK(received == 2 && receivedData[0] == 'f');
+
+    WireSlave.setFec(false);
+    Sim.clearTx();
+}
+
+static void testFormatting()
+{
+    WireSlave.onRequest(onRequestFormatted);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    CHECK(request.request());
+    char text[32] = {0};
+    for (int i = 0; request.available() && i < 31; ++i) {
+        text[i] = request.read();
+    }
+    CHECK(!strcmp(text, "t=7 -21.5 1.50"));
+
+    WireSlave.onRequest(onRequest);
+    Sim.clearTx();
+}
+
+// 121 bytes, fits a default packet only
+#define LARGE_FIELDS(FIELD) \
+    FIELD(uint64_t, f0) FIELD(uint64_t, f1) FIELD(uint64_t, f2) \
+    FIELD(uint64_t, f3) FIELD(uint64_t, f4) FIELD(uint64_t, f5) \
+    FIELD(uint64_t, f6) FIELD(uint64_t, f7) FIELD(uint64_t, f8) \
+    FIELD(uint64_t, f9) FIELD(uint64_t, f10) FIELD(uint64_t, f11) \
+    FIELD(uint64_t, f12) FIELD(uint64_t, f13) FIELD(uint64_t, f14)
+
+WIRE_MESSAGE(LargeMessage, 0x30, LARGE_FIELDS)
+
+static void testMessages()
+{
+    LargeMessage message = {};
+    message.f14 = 0x0102030405060708ULL;
+
+    WirePacker packer;
+    CHECK(message.writeTo(packer) == LargeMessage::LENGTH);
+
+    // with less room, nothing is written
+    WirePacker fec;
+    fec.setFec(true);
+    fec.write(1);
+    CHECK(message.writeTo(fec) == 0 && fec.payloadLength() == 1);
+
+    WirePacker wide;
+    wide.setFraming(FRAMING_COBS);
+    wide.setCrc(CRC_32);
+    CHECK(message.writeTo(wide) == 0 && wide.payloadLength() == 0);
+
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.setFec(true);
+    CHECK(message.writeTo(write) == 0);
+}
+
+static void testCrc()
+{
+    WireSlave.setCrc(CRC_32);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.setCrc(CRC_32);
+    CHECK(request.request());
+    CHECK(request.available() == 5 && request.read() == 'h');
+
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.setCrc(CRC_32);
+    write.write(3);
+    write.print("cr");
+    CHECK(write.send());
+    CHECK(received == 2 && receivedData[0] == 'c');
+
+    WireSlave.setCrc(CRC_16);
+    WireSlave.setFec(true);
+    WireSlave.setFraming(FRAMING_COBS);
+    WireSlaveRequest all(Wire, SLAVE_ADDR, 32);
+    all.setCrc(CRC_16);
+    all.setFec(true);
+    all.setFraming(FRAMING_COBS);
+    CHECK(all.request());
+    CHECK(all.available() == 5 && all.read() == 'h');
+
+    WireSlave.setCrc(CRC_8);
+    WireSlave.setFec(false);
+    WireSlave.setFraming(FRAMING_STX);
+    Sim.clearTx();
+}
+
+static void testBroadcast()
+{
+    Sim.setGeneralCall(true);
+
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.write(3);
+    write.print("bc");
+    CHECK(write.broadcast());
+    delay(2);
+    CHECK(received == 2 && receivedBroadcast && receivedData[0] == 'b');
+    CHECK(Sim.txPending() == 0);
+
+    WireSlaveWrite single(Wire, SLAVE_ADDR);
+    single.write(3);
+    single.print("nb");
+    CHECK(single.send());
+    CHECK(!receivedBroadcast);
+
+    // the COBS code byte could be a general call command
+    WireSlaveWrite cobs(Wire, SLAVE_ADDR);
+    cobs.setFraming(FRAMING_COBS);
+    cobs.write(3);
+    uint32_t transactions = Sim.transactionCount();
+    CHECK(!cobs.broadcast() && cobs.lastStatus() == WireSlaveWrite::UNSUPPORTED);
+    CHECK(Sim.transactionCount() == transactions);
+
+    Sim.setGeneralCall(false);
+    Sim.clearTx();
+
+    // the stubs are a classic ESP32: general call is left off, but
+    // the slave still starts
+    TwoWireSlaveConfig config;
+    config.generalCall = true;
+    CHECK(WireSlave1.begin(21, 22, SLAVE_ADDR, config));
+}
+
+static void testScanner()
+{
+    WireScanner scanner(Wire, 1, 0x77);
+    CHECK(scanner.scan() == 1);
+    CHECK(scanner.isAlive(SLAVE_ADDR));
+    CHECK(scanner.nextAlive(0) == SLAVE_ADDR && scanner.nextAlive(SLAVE_ADDR) == 0);
+
+    // a missing slave is probed again, one address per update()
+    scanner.markMissing(SLAVE_ADDR);
+    uint32_t before = Sim.transactionCount();
+    delay(1001);
+    for (int i = 0; i < 200; ++i) {
+        scanner.update();
+    }
+    CHECK(scanner.isAlive(SLAVE_ADDR));
+    CHECK(Sim.transactionCount() - before == 0x77);
+
+    // an alive slave is probed again once it goes unseen
+    TwoWireTransport transport(Wire);
+    WireScanner watcher(transport, 1, 0x77);
+    watcher.setAliveProbeInterval(500);
+    watcher.setDeadProbeInterval(60000);
+    CHECK(watcher.scan() == 1);
+    before = Sim.transactionCount();
+    watcher.update();
+    CHECK(Sim.transactionCount() == before);
+    Sim.setSlaveAddress(SLAVE_ADDR + 1);
+    delay(501);
+    watcher.update();
+    CHECK(Sim.transactionCount() - before == 1);
+    CHECK(!watcher.isAlive(SLAVE_ADDR) && watcher.aliveCount() == 0);
+    Sim.setSlaveAddress(SLAVE_ADDR);
+}
+
+static void testCapture()
+{
+    static uint8_t buffer[8192];
+    WireCapture capture(buffer, sizeof(buffer));
+    WireSlave.setCapture(&capture);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    CHECK(request.request());
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    write.write(3);
+    write.print("cap");
+    CHECK(write.send());
+    WireSlave.setChunkOffset(0);
+    WireBulkWrite bulk(Wire, SLAVE_ADDR);
+    CHECK(bulk.send(image, 3000));
+
+    WireSlave.setCapture(nullptr);
+    CHECK(capture.available() > 0 && capture.droppedCount() == 0);
+
+    // records are whole, even when some are dropped
+    static uint8_t small[40];
+    WireCapture full(small, sizeof(small));
+    uint8_t data[20] = {1};
+    for (int i = 0; i < 10; ++i) {
+        full.record(WireCapture::READ, i, data, 10 + i % 3);
+    }
+    CHECK(full.droppedCount() > 0);
+    uint8_t records[40];
+    size_t length = full.read(records, sizeof(records));
+    size_t parsed = 0;
+    while (parsed < length) {
+        parsed += 6 + records[parsed + 5];
+    }
+    CHECK(records[0] == 'R' && parsed == length);
+}
+
+static void testNotifier()
+{
+    Sim.setPin(DATA_READY_PIN, HIGH);
+    WireSlave.setDataReadyPin(DATA_READY_PIN);
+    CHECK(Sim.pin(DATA_READY_PIN) == HIGH && !WireSlave.isNotifying());
+
+    WireNotifier notifier;
+    notifier.add(SLAVE_ADDR, DATA_READY_PIN);
+    notifier.add(7, DATA_READY_PIN);
+    CHECK(notifier.update() == 0 && notifier.next() == 0);
+
+    WireSlave.notify();
+    CHECK(Sim.pin(DATA_READY_PIN) == LOW);
+
+    static int handled;
+    handled = 0;
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    uint8_t count = notifier.requestPending(request,
+        [](uint8_t address, WireSlaveRequest &response) {
+            CHECK(address == SLAVE_ADDR && response.read() == 'h');
+            ++handled;
+        });
+    CHECK(count == 1 && handled == 1);
+    CHECK(Sim.pin(DATA_READY_PIN) == HIGH && !WireSlave.isNotifying());
+    CHECK(notifier.update() == 0);
+
+    notifier.setPending(SLAVE_ADDR);
+    notifier.setPending(100);
+    CHECK(notifier.next() == 100 && notifier.next() == SLAVE_ADDR);
+    CHECK(notifier.next() == 0);
+
+    // a broken read: the retried request asserts the line again,
+    // and the next request releases it
+    WireSlave.notify();
+    Sim.flipNextRead(2);
+    CHECK(request.request(SLAVE_ADDR) && request.read() == 'h');
+    CHECK(request.retryCount() == 1 && WireSlave.isNotifying());
+    CHECK(request.request() && !WireSlave.isNotifying());
+
+    WireSlave.setDataReadyPin(-1);
+    Sim.clearTx();
+}
+
+static void testAsync()
+{
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 32);
+    request.start();
+    CHECK(request.isBusy());
+    while (!request.poll()) {
+        delay(1);
+    }
+    CHECK(request.lastStatus() == WireSlaveRequest::PACKET_READ);
+    CHECK(request.read() == 'h');
+
+    WireSlaveRequest missing(Wire, MISSING_ADDR, 32);
+    missing.start();
+    while (!missing.poll()) {
+        delay(1);
+    }
+    CHECK(missing.lastStatus() == WireSlaveRequest::SLAVE_NOT_FOUND);
+    Sim.clearTx();
+}
+
+static void testSweep()
+{
+    LagTransport lag;
+    WireSlaveRequest request0(Wire, 0, 32);
+    WireSlaveRequest request1(lag, 0, 32);
+    const uint8_t slaves0[] = { SLAVE_ADDR, SLAVE_ADDR, SLAVE_ADDR };
+    const uint8_t slaves1[] = { SLAVE_ADDR, MISSING_ADDR, SLAVE_ADDR };
+
+    WireSweep sweep;
+    sweep.addBus(request0, slaves0, 3);
+    sweep.addBus(request1, slaves1, 3);
+
+    static int responses;
+    responses = 0;
+    sweep.onResponse([](uint8_t bus, uint8_t address, WireSlaveRequest &response) {
+        ++responses;
+        if (address == MISSING_ADDR) {
+            CHECK(bus == 1 && response.lastStatus() == WireSlaveRequest::SLAVE_NOT_FOUND);
+        }
+        else {
+            CHECK(response.lastStatus() == WireSlaveRequest::PACKET_READ);
+        }
+    });
+
+    sweep.begin();
+    while (sweep.poll()) {
+        delay(1);
+    }
+    CHECK(responses == 6);
+    CHECK(sweep.readCount() == 5 && sweep.failedCount() == 1);
+    Sim.clearTx();
+}
+
+static void testQueues()
+{
+    static uint8_t urgentBuffer[64];
+    static uint8_t routineBuffer[256];
+    WireQueue urgent(urgentBuffer, sizeof(urgentBuffer));
+    WireQueue routine(routineBuffer, sizeof(routineBuffer));
+    WireSlave.setQueue(0, &urgent);
+    WireSlave.setQueue(2, &routine);
+    urgent.setBudget(30000);
+
+    uint8_t telemetry[40];
+    memset(telemetry, 't', sizeof(telemetry));
+    for (int i = 0; i < 5; ++i) {
+        CHECK(WireSlave.queue(2, telemetry, sizeof(telemetry)));
+    }
+    CHECK(!WireSlave.queue(2, telemetry, sizeof(telemetry)));
+    CHECK(routine.droppedCount() == 1);
+
+    // no queue at priority 1
+    CHECK(!WireSlave.queue(1, telemetry, 1));
+
+    delay(3);
+    const uint8_t alarm[] = { 'A', '!' };
+    CHECK(WireSlave.queue(0, alarm, sizeof(alarm)));
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, 64);
+    CHECK(request.request() && request.available() == 2 && request.read() == 'A');
+    for (int i = 0; i < 5; ++i) {
+        CHECK(request.request() && request.read() == 't');
+    }
+    // the last one is kept until the next request
+    CHECK(WireSlave.hasQueued() && routine.count() == 1);
+
+    // queues empty, back to onRequest()
+    CHECK(request.request() && request.read() == 'h');
+    CHECK(!WireSlave.hasQueued());
+    CHECK(urgent.sentCount() == 1 && routine.sentCount() == 5);
+    CHECK(urgent.maxLatency() < routine.maxLatency());
+
+    // a broken read doesn't lose the message, the retry gets it again
+    CHECK(WireSlave.queue(0, alarm, sizeof(alarm)));
+    Sim.flipNextRead(2);
+    CHECK(request.request() && request.read() == 'A');
+    CHECK(request.request() && request.read() == 'h');
+    CHECK(urgent.sentCount() == 2 && urgent.isEmpty());
+
+    // nor a request that fails for good, the next one asks again
+    CHECK(WireSlave.queue(0, alarm, sizeof(alarm)));
+    Sim.flipNextRead(2);
+    request.setAttempts(1);
+    CHECK(!request.request());
+    request.setAttempts(5);
+    CHECK(request.request() && request.read() == 'A');
+    CHECK(request.request() && request.read() == 'h');
+
+    // with timestamps, messages that wouldn't fit a packet are refused
+    WireSlave.setTimestamps(true);
+    uint8_t large[PACKER_BUFFER_LENGTH];
+    for (size_t i = 0; i < sizeof(large); ++i) {
+        large[i] = uint8_t(i);
+    }
+    size_t largest = sizeof(large);
+    while (largest > 0 && !WireSlave.queue(2, large, largest)) {
+        --largest;
+    }
+    CHECK(largest > 100);
+    WireSlaveRequest whole(Wire, SLAVE_ADDR, 128);
+    whole.setTimestamps(true);
+    CHECK(whole.request() && whole.available() == largest);
+    bool isIntact = true;
+    for (size_t i = 0; i < largest; ++i) {
+        isIntact = isIntact && whole.read() == int(i);
+    }
+    CHECK(isIntact);
+    WireSlave.setTimestamps(false);
+
+    WireSlave.setQueue(0, nullptr);
+    WireSlave.setQueue(2, nullptr);
+    Sim.clearTx();
+}
+
+static int runScenarios()
+{
+    WireSlave.onReceive(onReceive);
+    WireSlave.onRequest(onRequest);
+
+    testRequest();
+    testPool();
+    testReceive();
+    testStream(FRAMING_STX, 1000);
+    testStream(FRAMING_COBS, 1000);
+    // two full packets fill the TX ring, the closing one must wait
+    testStream(FRAMING_STX, 248);
+    testBulk();
+    testTimeSync();
+    testDelta();
+    testEndpoints();
+    testSlaveWrite();
+    testCobs();
+    testFec();
+    testFormatting();
+    testMessages();
+    testCrc();
+    testBroadcast();
+    testScanner();
+    testCapture();
+    testNotifier();
+    testAsync();
+    testSweep();
+    testQueues();
+
+    printf("%d failed checks\n", failures);
+    return failures;
+}
+
+// load run
+
+struct LoadConfig
+{
+    unsigned long count = 0;
+    uint32_t clock = 100000;
+    double bitErrorRate = 0;
+    uint32_t seed = 1;
+    uint8_t length = 32;
+    WireCrcWidth crc = CRC_8;
+    bool fec = false;
+    bool cobs = false;
+
+    // slave driver settings, see TwoWireSlaveConfig
+    TwoWireSlaveConfig slave;
+    uint32_t updatePeriod = 1;
+};
+
+static uint8_t loadLength = 32;
+static uint32_t loadSequence = 0;
+static uint8_t loadWritten[PACKER_BUFFER_LENGTH];
+static bool loadWriteMatches = true;
+
+// payload depends on the sequence, so a corrupted packet that
+// passes the CRC shows up as a mismatch
+static uint8_t loadByte(uint32_t sequence, uint8_t i)
+{
+    return uint8_t(sequence * 31 + i * 7);
+}
+
+static void onLoadRequest()
+{
+    WireSlave.write((const uint8_t *) &loadSequence, 4);
+    for (uint8_t i = 4; i < loadLength; ++i) {
+        WireSlave.write(loadByte(loadSequence, i));
+    }
+}
+
+static void onLoadReceive(int count)
+{
+    for (int i = 0; i < count; ++i) {
+        uint8_t data = WireSlave.read();
+        if (count != loadLength || data != loadWritten[i]) {
+            loadWriteMatches = false;
+        }
+    }
+}
+
+static int runLoad(const LoadConfig &config)
+{
+    Sim.reset();
+    Sim.setClock(config.clock);
+    Sim.setBitErrorRate(config.bitErrorRate, config.seed);
+    Sim.setUpdatePeriod(config.updatePeriod);
+
+    if (!WireSlave.begin(21, 22, SLAVE_ADDR, config.slave)) {
+        fprintf(stderr, "I2C slave init failed\n");
+        return 2;
+    }
+
+    loadLength = config.length;
+    WireSlave.setCrc(config.crc);
+    WireSlave.setFec(config.fec);
+    WireSlave.setFraming(config.cobs ? FRAMING_COBS : FRAMING_STX);
+    WireSlave.onRequest(onLoadRequest);
+    WireSlave.onReceive(onLoadReceive);
+
+    WireSlaveRequest request(Wire, SLAVE_ADDR, config.length);
+    WireSlaveWrite write(Wire, SLAVE_ADDR);
+    request.setCrc(config.crc);
+    request.setFec(config.fec);
+    request.setFraming(config.cobs ? FRAMING_COBS : FRAMING_STX);
+    write.setCrc(config.crc);
+    write.setFec(config.fec);
+    write.setFraming(config.cobs ? FRAMING_COBS : FRAMING_STX);
+
+    unsigned long requests = 0, requestsFailed = 0;
+    unsigned long writes = 0, writesFailed = 0;
+    unsigned long corruptAccepted = 0;
+
+    uint64_t startNanos = Sim.nanos();
+    clock_t startClock = clock();
+
+    for (unsigned long n = 0; n < config.count; ++n) {
+        loadSequence = n;
+
+        if (n % 2 == 0) {
+            ++requests;
+            if (!request.request()) {
+                ++requestsFailed;
+                Sim.clearTx();
+                continue;
+            }
+            bool matches = request.available() == loadLength;
+            uint32_t sequence = 0;
+            for (uint8_t i = 0; i < 4; ++i) {
+                sequence |= uint32_t(request.read()) << (8 * i);
+            }
+            for (uint8_t i = 4; i < loadLength; ++i) {
+                matches &= request.read() == loadByte(sequence, i);
+            }
+            if (!matches) {
+                ++corruptAccepted;
+            }
+        }
+        else {
+            ++writes;
+            loadWriteMatches = true;
+            for (uint8_t i = 0; i < loadLength; ++i) {
+                loadWritten[i] = loadByte(n, i);
+                write.write(loadWritten[i]);
+            }
+            if (!write.send()) {
+                ++writesFailed;
+                Sim.clearTx();
+            }
+            if (!loadWriteMatches) {
+                ++corruptAccepted;
+            }
+        }
+    }
+
+    double seconds = (Sim.nanos() - startNanos) / 1e9;
+    double cpuSeconds = double(clock() - startClock) / CLOCKS_PER_SEC;
+
+    printf("%lu packets of %u bytes at %lu Hz, bit error rate %g\n",
+        config.count, config.length, (unsigned long) config.clock, config.bitErrorRate);
+    printf("  requests        %8lu, %lu failed, %lu retries, %lu corrected\n",
+        requests, requestsFailed, (unsigned long) request.retryCount(),
+        (unsigned long) request.correctedCount());
+    printf("  writes          %8lu, %lu failed\n", writes, writesFailed);
+    printf("  corrupt accepted %7lu\n", corruptAccepted);
+    printf("  bus             %8lu transactions, %lu bytes, %lu flipped bits\n",
+        (unsigned long) Sim.transactionCount(), (unsigned long) Sim.byteCount(),
+        (unsigned long) Sim.flippedBitCount());
+    printf("  simulated time  %8.3f s, %.0f packets/s\n",
+        seconds, seconds > 0 ? config.count / seconds : 0);
+    printf("  slave           %u byte rings, update() every %lu ms, %lu ticks read timeout\n",
+        (unsigned) config.slave.rxBufferLength, (unsigned long) config.updatePeriod,
+        (unsigned long) config.slave.readTimeout);
+    printf("  slave           %8lu bytes lost to RX overflow, %lu ticks blocked\n",
+        (unsigned long) Sim.overflowCount(), (unsigned long) Sim.blockedTicks());
+    printf("  host time       %8.3f s, %.0f packets/s\n",
+        cpuSeconds, cpuSeconds > 0 ? config.count / cpuSeconds : 0);
+
+    return corruptAccepted ? 1 : 0;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+        "usage: wire_sim [-n count] [-c clock] [-e bit_error_rate] [-s seed]\n"
+        "                [-l length] [-k crc_width] [-f] [-x]\n"
+        "                [-r ring_length] [-p update_period] [-b read_timeout]\n"
+        "  no options   run the scenarios\n"
+        "  -n count     load run of count requests and writes\n"
+        "  -c clock     bus clock, in Hz (100000)\n"
+        "  -e rate      bit error rate (0)\n"
+        "  -s seed      seed of the bit errors (1)\n"
+        "  -l length    payload length, 5 to 100 (32)\n"
+        "  -k width     CRC width: 8, 16 or 32 (8)\n"
+        "  -f           forward error correction\n"
+        "  -x           COBS framing\n"
+        "  -r length    slave driver RX and TX ring length (256)\n"
+        "  -p ms        period of WireSlave.update() calls (1)\n"
+        "  -b ticks     update() read timeout (1)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    LoadConfig config;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:c:e:s:l:k:fxr:p:b:")) != -1) {
+        switch (option) {
+        case 'n': config.count = strtoul(optarg, NULL, 10); break;
+        case 'c': config.clock = strtoul(optarg, NULL, 10); break;
+        case 'e': config.bitErrorRate = atof(optarg); break;
+        case 's': config.seed = strtoul(optarg, NULL, 10); break;
+        case 'l': config.length = atoi(optarg); break;
+        case 'k':
+            config.crc = atoi(optarg) == 32 ? CRC_32
+                : atoi(optarg) == 16 ? CRC_16 : CRC_8;
+            break;
+        case 'f': config.fec = true; break;
+        case 'x': config.cobs = true; break;
+        case 'r':
+            config.slave.rxBufferLength = strtoul(optarg, NULL, 10);
+            config.slave.txBufferLength = config.slave.rxBufferLength;
+            break;
+        case 'p': config.updatePeriod = strtoul(optarg, NULL, 10); break;
+        case 'b': config.slave.readTimeout = strtoul(optarg, NULL, 10); break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+
+    if (config.clock == 0 || config.length < 5 || config.length > 100) {
+        usage();
+        return 2;
+    }
+
+    if (config.count) {
+        return runLoad(config);
+    }
+
+    if (!WireSlave.begin(21, 22, SLAVE_ADDR)) {
+        fprintf(stderr, "I2C slave init failed\n");
+        return 2;
+    }
+    return runScenarios() ? 1 : 0;
+}
@@ -0,0 +1,288 @@
+#include "WireBulkWrite.h"
+#include "WireUnpacker.h"
+
+#ifdef ARDUINO
+WireBulkWrite::WireBulkWrite(TwoWire &wire, uint8_t address)
+    :wire_(wire)
+    ,transport_(wire_)
+    ,address_(address)
+    ,retryDelay_(10)
+    ,maxAttempts_(5)
+    ,window_(2)
+    ,chunkLength_(112)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,lastStatus_(NONE)
+    ,offset_(0)
+    ,data_(nullptr)
+    ,source_(nullptr)
+{
+}
+#endif
+
+WireBulkWrite::WireBulkWrite(WireTransport &transport, uint8_t address)
+    :transport_(transport)
+    ,address_(address)
+    ,retryDelay_(10)
+    ,maxAttempts_(5)
+    ,window_(2)
+    ,chunkLength_(112)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,lastStatus_(NONE)
+    ,offset_(0)
+    ,data_(nullptr)
+    ,source_(nullptr)
+{
+}
+
+bool WireBulkWrite::send(const uint8_t *data, uint32_t length)
+{
+    data_ = data;
+    source_ = nullptr;
+    return transfer(length);
+}
+
+bool WireBulkWrite::send(size_t (*source)(uint32_t, uint8_t*, size_t), uint32_t length)
+{
+    data_ = nullptr;
+    source_ = source;
+    return transfer(length);
+}
+
+bool WireBulkWrite::transfer(uint32_t length)
+{
+    // resume from where the slave stopped
+    if (!readOffset()) {
+        return false;
+    }
+
+    size_t chunkLength = chunkRoom();
+    uint32_t windowLength = uint32_t(window_) * chunkLength;
+    uint32_t next = offset_;
+    uint8_t attempts = 0;
+
+    while (offset_ < length) {
+        uint32_t acknowledged = offset_;
+        uint32_t end = length - offset_ > windowLength ? offset_ + windowLength : length;
+
+        // chunks still in flight aren't sent again. The query goes
+        // before the last new chunk, so the slave answers it while
+        // that chunk is on the bus, and it's read without waiting
+        uint32_t queried = next;
+        bool isQueried = false;
+
+        while (next < end) {
+            if (next > offset_ && end - next <= chunkLength) {
+                if (!sendQuery()) {
+                    lastStatus_ = SLAVE_NOT_FOUND;
+                    return false;
+                }
+                queried = next;
+                isQueried = true;
+            }
+
+            size_t sent = 0;
+            if (!sendChunk(next, end - next, sent)) {
+                lastStatus_ = SLAVE_NOT_FOUND;
+                return false;
+            }
+            if (sent == 0) {
+                break;
+            }
+            next += sent;
+        }
+
+        if (isQueried) {
+            if (!awaitAnswer()) {
+                return false;
+            }
+        }
+        else {
+            queried = next;
+            if (!readOffset()) {
+                return false;
+            }
+        }
+
+        if (offset_ > acknowledged) {
+            attempts = 0;
+        }
+        else if (++attempts >= maxAttempts_) {
+            // chunks lost or refused by the slave every time
+            lastStatus_ = MAX_ATTEMPTS;
+            return false;
+        }
+
+        if (offset_ < queried) {
+            // the slave drops the chunks after a lost or refused
+            // one, so go back to it
+            next = offset_;
+        }
+    }
+
+    lastStatus_ = COMPLETE;
+    return true;
+}
+
+size_t WireBulkWrite::chunkRoom() const
+{
+    WirePacker packer;
+    packer.setFraming(framing_);
+    packer.setFec(isFecEnabled_);
+    packer.setCrc(crcWidth_);
+    packer.reset(FRAME_CHUNK);
+    for (uint8_t i = 0; i < 4; ++i) {
+        packer.write(uint8_t(0));
+    }
+
+    size_t room = packer.room();
+    return room < chunkLength_ ? room : chunkLength_;
+}
+
+bool WireBulkWrite::sendChunk(uint32_t offset, uint32_t remaining, size_t &sent)
+{
+    WirePacker packer;
+    packer.setFraming(framing_);
+    packer.setFec(isFecEnabled_);
+    packer.setCrc(crcWidth_);
+    packer.reset(FRAME_CHUNK);
+
+    for (uint8_t i = 0; i < 4; ++i) {
+        packer.write(uint8_t(offset >> (8 * i)));
+    }
+
+    uint8_t chunk[PACKER_BUFFER_LENGTH];
+    size_t length = remaining < chunkLength_ ? remaining : chunkLength_;
+    if (length > sizeof(chunk)) {
+        length = sizeof(chunk);
+    }
+
+    if (source_) {
+        length = source_(offset, chunk, length);
+        sent = packer.write(chunk, length);
+    }
+    else {
+        // packer takes as much as fits
+        sent = packer.write(data_ + offset, length);
+    }
+
+    if (sent == 0) {
+        return true;
+    }
+
+    packer.end();
+
+    uint8_t packet[PACKER_BUFFER_LENGTH];
+    size_t packetLength = packer.read(packet, sizeof(packet));
+
+    return transport_.write(address_, packet, packetLength);
+}
+
+bool WireBulkWrite::sendQuery()
+{
+    // an empty chunk asks for the expected offset
+    WirePacker packer;
+    packer.setFraming(framing_);
+    packer.setFec(isFecEnabled_);
+    packer.setCrc(crcWidth_);
+    packer.reset(FRAME_CHUNK);
+    for (uint8_t i = 0; i < 4; ++i) {
+        packer.write(uint8_t(offset_ >> (8 * i)));
+    }
+    packer.end();
+
+    uint8_t query[PACKER_BUFFER_LENGTH];
+    size_t queryLength = packer.read(query, sizeof(query));
+
+    return transport_.write(address_, query, queryLength);
+}
+
+int WireBulkWrite::readAnswer()
+{
+    uint8_t answer[PACKER_BUFFER_LENGTH];
+    uint8_t answerLength = wireFrameLength(wirePacketLength(4, isFecEnabled_, crcWidth_), framing_);
+
+    size_t returned = transport_.read(address_, answer, answerLength);
+    if (returned == 0) {
+        lastStatus_ = SLAVE_NOT_FOUND;
+        return -1;
+    }
+
+    WireUnpacker unpacker;
+    unpacker.setFraming(framing_);
+    unpacker.setFec(isFecEnabled_);
+    unpacker.write(answer, returned);
+
+    if (unpacker.isPacketOpen() || unpacker.hasError()
+            || unpacker.frameType() != FRAME_ACK || unpacker.available() != 4) {
+        return 0;
+    }
+
+    offset_ = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        offset_ |= uint32_t(unpacker.read()) << (8 * i);
+    }
+    return 1;
+}
+
+bool WireBulkWrite::awaitAnswer()
+{
+    // first read at once, then as readOffset() does, without asking
+    // again: a second answer would be left in the slave TX buffer
+    for (uint8_t attempts = 0; attempts < maxAttempts_; ++attempts) {
+        if (attempts > 0) {
+            transport_.delay(retryDelay_ * attempts);
+        }
+
+        int answer = readAnswer();
+        if (answer != 0) {
+            return answer > 0;
+        }
+    }
+
+    // the query itself was lost
+    return readOffset();
+}
+
+bool WireBulkWrite::readOffset()
+{
+    for (uint8_t attempts = 0; attempts < maxAttempts_; ++attempts) {
+        if (!sendQuery()) {
+            lastStatus_ = SLAVE_NOT_FOUND;
+            return false;
+        }
+
+        // wait until slave stores the chunks and answers
+        transport_.delay(retryDelay_ * (attempts + 1));
+
+        int answer = readAnswer();
+        if (answer < 0) {
+            return false;
+        }
+        if (answer > 0) {
+            lastStatus_ = NONE;
+            return true;
+        }
+    }
+
+    lastStatus_ = MAX_ATTEMPTS;
+    return false;
+}
+
+#ifdef ARDUINO
+String WireBulkWrite::lastStatusToString() const
+#else
+const char *WireBulkWrite::lastStatusToString() const
+#endif
+{
+    switch (lastStatus_) {
+    case NONE: return "none";
+    case COMPLETE: return "complete";
+    case SLAVE_NOT_FOUND: return "slave not found";
+    case MAX_ATTEMPTS: return "max attempts";
+    default: return "unknown";
+    }
+}
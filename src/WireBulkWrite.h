@@ -0,0 +1,247 @@
+/**
+ * @file WireBulkWrite.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Bulk transfer of large data to an ESP32 slave
+ * @date 2026-10-18
+ *
+ * Sends data much longer than a packet, like a firmware image,
+ * to a slave that registered TwoWireSlave::onChunk().
+ *
+ * The data is split in FRAME_CHUNK packets, each one holding the
+ * offset of its first byte. An empty chunk asks the slave for the
+ * offset it expects next (cumulative acknowledge). Up to a window
+ * of chunks is in flight: the query goes before the last chunk
+ * sent, so the slave answers it while that chunk is on the bus,
+ * and each answer makes room for as many new chunks as it
+ * acknowledges, without waiting for the whole window. After a lost
+ * or refused chunk, sending goes back to the offset the slave
+ * expects, and a transfer interrupted on either side continues
+ * where the slave stopped. The retry delay is only waited when an
+ * answer isn't ready.
+ *
+ * Data comes from a buffer or from a source callback, which reads
+ * only the chunk being sent (from a file, for instance).
+ *
+ * Data from the slave to the master is sent with
+ * TwoWireSlave::onStream() and WireSlaveRequest::readStream().
+ *
+ */
+#ifndef WireBulkWrite_h
+#define WireBulkWrite_h
+
+#include <stdint.h>
+#include "WireTransport.h"
+#include "WirePacker.h"
+
+class WireBulkWrite
+{
+public:
+    enum Status
+    {
+        NONE,
+        COMPLETE,
+        SLAVE_NOT_FOUND,
+        MAX_ATTEMPTS,
+    };
+
+    /**
+     * Construct a new WireBulkWrite object
+     *
+     * @param wire      TwoWire object (Wire or Wire1)
+     * @param address   slave address
+     */
+#ifdef ARDUINO
+    WireBulkWrite(TwoWire &wire, uint8_t address);
+#endif
+
+    /**
+     * Construct a new WireBulkWrite object on another bus
+     *
+     * @param transport bus access, see WireTransport.h
+     * @param address   slave address
+     */
+    WireBulkWrite(WireTransport &transport, uint8_t address);
+
+    /**
+     * Delay in milliseconds between sending a window and reading
+     * the slave offset. It must cover the time the slave takes to
+     * store the window.
+     */
+    void setRetryDelay(unsigned long retryDelay)
+    {
+        retryDelay_ = retryDelay;
+    }
+
+    /**
+     * Number of windows in a row without progress, or of offset
+     * reads without answer, before giving up with an error status
+     */
+    void setAttempts(uint8_t attempts)
+    {
+        maxAttempts_ = attempts;
+    }
+
+    /**
+     * Number of chunks in flight, sent but not acknowledged yet, 2 by
+     * default. The slave driver RX buffer must hold them, at chunk
+     * length + 8 bytes each, plus 8 bytes of the offset request.
+     */
+    void setWindow(uint8_t chunks)
+    {
+        window_ = chunks > 0 ? chunks : 1;
+    }
+
+    /**
+     * Max data bytes per chunk, 112 by default so that the default
+     * window fits the default slave buffers. Longer values are cut
+     * to what fits in a packet.
+     */
+    void setChunkLength(uint8_t length)
+    {
+        chunkLength_ = length > 0 ? length : 1;
+    }
+
+    /**
+     * Selects the packet framing (see WireFrame.h), which must
+     * match the one used by the slave.
+     *
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        framing_ = framing;
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec()),
+     * which must match the slave.
+     *
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        isFecEnabled_ = enabled;
+    }
+
+    /**
+     * Selects the CRC width (see WireFrame.h), which must match
+     * the slave.
+     * Each extra CRC byte takes one byte of every chunk.
+     *
+     * @param width     CRC_8 (default), CRC_16 or CRC_32
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        crcWidth_ = width;
+    }
+
+    /**
+     * @brief Sends a buffer, starting from the offset the slave
+     * expects. Returns once the slave has acknowledged all of it.
+     *
+     * @param data      bytes to send
+     * @param length    number of bytes
+     * @return true     the slave received every byte
+     * @return false    something wrong happened, check lastStatus()
+     */
+    bool send(const uint8_t *data, uint32_t length);
+
+    /**
+     * @brief Same as send(data, length), reading each chunk from a
+     * source callback instead of a buffer.
+     *
+     * @param source    called as source(offset, buffer, length), copies
+     *                  up to length bytes from offset to buffer and
+     *                  returns how many were copied
+     * @param length    total number of bytes
+     */
+    bool send(size_t (*source)(uint32_t, uint8_t*, size_t), uint32_t length);
+
+    /**
+     * @brief Reads the offset the slave expects next, also updating
+     * offset(). Useful to show the progress of an interrupted transfer.
+     *
+     * @return true     the slave answered
+     */
+    bool readOffset();
+
+    /**
+     * Number of bytes acknowledged by the slave.
+     */
+    uint32_t offset() const
+    {
+        return offset_;
+    }
+
+    Status lastStatus() const
+    {
+        return lastStatus_;
+    }
+
+#ifdef ARDUINO
+    String lastStatusToString() const;
+#else
+    const char *lastStatusToString() const;
+#endif
+
+private:
+#ifdef ARDUINO
+    TwoWireTransport wire_;
+#endif
+    WireTransport &transport_;
+    uint8_t address_;
+    unsigned long retryDelay_;
+    uint8_t maxAttempts_;
+    uint8_t window_;
+    uint8_t chunkLength_;
+    WireFraming framing_;
+    bool isFecEnabled_;
+    WireCrcWidth crcWidth_;
+    Status lastStatus_;
+    uint32_t offset_;
+
+    const uint8_t *data_;
+    size_t (*source_)(uint32_t, uint8_t*, size_t);
+
+    /**
+     * Sends windows until the slave acknowledges length bytes.
+     */
+    bool transfer(uint32_t length);
+
+    /**
+     * Data bytes in a full chunk, chunkLength_ or what fits a packet.
+     */
+    size_t chunkRoom() const;
+
+    /**
+     * Sends one chunk starting at offset.
+     *
+     * @param offset    offset of the first byte
+     * @param remaining number of bytes left from offset
+     * @param sent      number of data bytes sent
+     * @return false    the slave didn't answer
+     */
+    bool sendChunk(uint32_t offset, uint32_t remaining, size_t &sent);
+
+    /**
+     * Sends an empty chunk, answered with the offset the slave
+     * expects once it has handled the chunks sent before.
+     */
+    bool sendQuery();
+
+    /**
+     * Reads the answer to the last query, updating offset().
+     *
+     * @return int      1 if read, 0 if not staged yet or broken,
+     *                  -1 if the slave didn't answer
+     */
+    int readAnswer();
+
+    /**
+     * Reads the answer to a query sent before a chunk, waiting if
+     * it isn't ready; asks again if it never comes.
+     */
+    bool awaitAnswer();
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file WireCapture.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Ring buffer recording the raw bytes of a slave
+ * @date 2026-10-18
+ *
+ */
+#include "WireCapture.h"
+
+WireCapture::WireCapture(uint8_t *buffer, size_t size)
+    :buffer_(buffer)
+    ,size_(size)
+    ,head_(0)
+    ,used_(0)
+    ,droppedCount_(0)
+{
+}
+
+void WireCapture::record(Kind kind, uint32_t time, const uint8_t *data, size_t length)
+{
+    if (length > UINT8_MAX || WIRECAPTURE_RECORD_HEADER + length > size_) {
+        ++droppedCount_;
+        return;
+    }
+
+    while (size_ - used_ < WIRECAPTURE_RECORD_HEADER + length) {
+        dropFirstRecord();
+    }
+
+    put(kind);
+    for (uint8_t i = 0; i < 4; ++i) {
+        put(uint8_t(time >> (8 * i)));
+    }
+    put(uint8_t(length));
+    for (size_t i = 0; i < length; ++i) {
+        put(data[i]);
+    }
+}
+
+size_t WireCapture::read(uint8_t *data, size_t length)
+{
+    size_t count = 0;
+
+    while (used_ > 0) {
+        size_t recordLength = firstRecordLength();
+        if (count + recordLength > length) {
+            break;
+        }
+
+        for (size_t i = 0; i < recordLength; ++i) {
+            data[count + i] = at(i);
+        }
+        count += recordLength;
+
+        head_ = (head_ + recordLength) % size_;
+        used_ -= recordLength;
+    }
+
+    return count;
+}
+
+void WireCapture::clear()
+{
+    head_ = 0;
+    used_ = 0;
+    droppedCount_ = 0;
+}
+
+#ifdef ARDUINO
+size_t WireCapture::writeTo(Print &output)
+{
+    const uint8_t header[] = { 'W', 'C', 'A', 'P', WIRECAPTURE_VERSION };
+    size_t count = output.write(header, sizeof(header));
+
+    // room for the longest record
+    uint8_t chunk[WIRECAPTURE_RECORD_HEADER + UINT8_MAX];
+    size_t length;
+    while ((length = read(chunk, sizeof(chunk))) > 0) {
+        count += output.write(chunk, length);
+    }
+
+    return count;
+}
+#endif
+
+void WireCapture::put(uint8_t data)
+{
+    buffer_[(head_ + used_) % size_] = data;
+    ++used_;
+}
+
+void WireCapture::dropFirstRecord()
+{
+    size_t recordLength = firstRecordLength();
+    head_ = (head_ + recordLength) % size_;
+    used_ -= recordLength;
+    ++droppedCount_;
+}
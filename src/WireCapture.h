@@ -0,0 +1,138 @@
+/**
+ * @file WireCapture.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Ring buffer recording the raw bytes of a slave
+ * @date 2026-10-18
+ *
+ * With TwoWireSlave::setCapture(), every driver read and write is
+ * recorded with a timestamp, so the exact byte stream of a field
+ * problem can be saved and fed back later, with the replay tool in
+ * extras/wire_replay. The buffer is given by the user; when it's
+ * full, the oldest records are dropped.
+ *
+ * Capture file format, all numbers little endian:
+ *      header: "WCAP", version (WIRECAPTURE_VERSION)
+ *      records, oldest first:
+ *          [0]: kind, one of WireCapture::Kind
+ *          [1..4]: timestamp in microseconds (wraps around)
+ *          [5]: data length n
+ *          [6..n+5]: data
+ *
+ * Record kinds:
+ *      READ: bytes returned by i2c_slave_read_buffer()
+ *      WRITE: bytes accepted by i2c_slave_write_buffer()
+ *      RESET_TX: TX FIFO reset, no data
+ *      CONFIG: framing (WireFraming) and FEC (0 or 1), recorded by
+ *          setCapture(), setFraming() and setFec()
+ *
+ * writeTo() writes the header and the records, so a capture file
+ * is simply what it sent to Serial or to a file.
+ *
+ */
+#ifndef WireCapture_h
+#define WireCapture_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Print.h>
+#endif
+
+#define WIRECAPTURE_VERSION 1
+
+// kind, timestamp and length bytes before the data of each record
+#define WIRECAPTURE_RECORD_HEADER 6
+
+class WireCapture
+{
+public:
+    enum Kind : uint8_t
+    {
+        READ = 'R',
+        WRITE = 'W',
+        RESET_TX = 'T',
+        CONFIG = 'C',
+    };
+
+    /**
+     * Construct a new WireCapture object
+     *
+     * @param buffer    memory for the records, must stay valid
+     * @param size      buffer size in bytes
+     */
+    WireCapture(uint8_t *buffer, size_t size);
+
+    /**
+     * Adds a record, dropping the oldest ones to make room. Records
+     * longer than the buffer are not added.
+     *
+     * @param kind      record kind
+     * @param time      timestamp in microseconds
+     * @param data      record data
+     * @param length    number of data bytes, up to 255
+     */
+    void record(Kind kind, uint32_t time, const uint8_t *data = nullptr, size_t length = 0);
+
+    /**
+     * Returns how many record bytes are waiting to be read.
+     */
+    size_t available() const
+    {
+        return used_;
+    }
+
+    /**
+     * Reads whole records, oldest first, removing them from the buffer.
+     *
+     * @param data      destination array
+     * @param length    max number of bytes to read
+     * @return size_t   number of bytes read
+     */
+    size_t read(uint8_t *data, size_t length);
+
+    /**
+     * Number of records dropped because the buffer was full.
+     */
+    uint32_t droppedCount() const
+    {
+        return droppedCount_;
+    }
+
+    void clear();
+
+#ifdef ARDUINO
+    /**
+     * Writes the file header and every record, emptying the buffer.
+     *
+     * @param output    Serial, a file or any other Print
+     * @return size_t   number of bytes written
+     */
+    size_t writeTo(Print &output);
+#endif
+
+private:
+    uint8_t *buffer_;
+    size_t size_;
+    size_t head_;
+    size_t used_;
+    uint32_t droppedCount_;
+
+    uint8_t at(size_t index) const
+    {
+        return buffer_[(head_ + index) % size_];
+    }
+
+    /**
+     * Length of the oldest record.
+     */
+    size_t firstRecordLength() const
+    {
+        return WIRECAPTURE_RECORD_HEADER + at(WIRECAPTURE_RECORD_HEADER - 1);
+    }
+
+    void put(uint8_t data);
+    void dropFirstRecord();
+};
+
+#endif
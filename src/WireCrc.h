@@ -1,7 +1,7 @@
 /**
  * @file WireCrc.h
  * @author Gutierrez PS <https://github.com/gutierrezps>
- * @brief CRC8-MAXIM algorithm used in WirePacker
+ * @brief CRC algorithms used in WirePacker
  * @date 2020-06-16
  * 
  * Based on <https://www.devcoons.com/crc8/>
@@ -9,12 +9,27 @@
  * 
  * Use calc() for the first call, and update() to 
  * feed the CRC calculation with more data.
+ * 
+ * The wider CRCs selected with setCrc() (see WireFrame.h) are
+ * computed by wireCrc16() and wireCrc32(). On the ESP32 they call
+ * the CRC routines of the chip ROM, elsewhere the lookup table
+ * versions wireCrc16Table() and wireCrc32Table(). Both give the
+ * same results, and chain like the ROM routines: pass the result
+ * of a call as crc to continue over more data, 0 to start.
  */
 
 #ifndef WireCrc_h
 #define WireCrc_h
 
 #include <stdint.h>
+#include <stddef.h>
+#include "WireFrame.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_rom_crc.h>
+#endif
+
+extern const uint8_t wireCrc8Table[256];
 
 class WireCrc
 {
@@ -44,22 +59,9 @@ public:
      */
     uint8_t update(uint8_t *data, unsigned int length) {
         uint8_t crc = seed;
-        uint8_t extract;
-        uint8_t sum;
 
         for (unsigned int i = 0; i < length; i++) {
-            extract = *data;
-
-            for (char j = 8; j; j--) {
-                sum = (crc ^ extract) & 0x01;
-                crc >>= 1;
-                if (sum) {
-                    crc ^= 0x8C;
-                }
-                extract >>= 1;
-            }
-
-            data++;
+            crc = wireCrc8Table[crc ^ data[i]];
         }
 
         return crc;
@@ -69,4 +71,55 @@ private:
     uint8_t seed = 0;
 };
 
+/**
+ * CRC-16/X-25 (reflected polynomial 0x8408) and CRC-32 (reflected
+ * polynomial 0xEDB88320) with lookup tables.
+ * 
+ * @param crc       result of the previous call, 0 to start
+ * @param data      byte array
+ * @param length    number of bytes
+ */
+uint16_t wireCrc16Table(uint16_t crc, const uint8_t *data, size_t length);
+uint32_t wireCrc32Table(uint32_t crc, const uint8_t *data, size_t length);
+
+inline uint16_t wireCrc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+#ifdef ARDUINO_ARCH_ESP32
+    return esp_rom_crc16_le(crc, data, length);
+#else
+    return wireCrc16Table(crc, data, length);
+#endif
+}
+
+inline uint32_t wireCrc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+#ifdef ARDUINO_ARCH_ESP32
+    return esp_rom_crc32_le(crc, data, length);
+#else
+    return wireCrc32Table(crc, data, length);
+#endif
+}
+
+/**
+ * Returns the CRC of a packet, as written by WirePacker.
+ * 
+ * @param width     CRC width
+ * @param length    packet length byte
+ * @param payload   payload bytes
+ * @param count     number of payload bytes
+ */
+inline uint32_t wirePacketCrc(WireCrcWidth width, uint8_t length, uint8_t *payload, uint8_t count)
+{
+    if (width == CRC_16) {
+        return wireCrc16(wireCrc16(0, &length, 1), payload, count);
+    }
+    if (width == CRC_32) {
+        return wireCrc32(wireCrc32(0, &length, 1), payload, count);
+    }
+
+    WireCrc crc8;
+    crc8.calc(&length, 1);
+    return crc8.update(payload, count);
+}
+
 #endif
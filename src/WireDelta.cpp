@@ -0,0 +1,157 @@
+/**
+ * @file WireDelta.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Delta encoding of slave responses
+ * @date 2026-10-18
+ * 
+ */
+#include <string.h>
+#include "WireDelta.h"
+
+// unchanged bytes cheaper to resend than to start a new range
+#define DELTA_RANGE_GAP 2
+
+WireDeltaEncoder::WireDeltaEncoder()
+    :lastId_(0)
+{
+    reset();
+}
+
+size_t WireDeltaEncoder::encode(uint8_t ackId, const uint8_t *data, size_t length, uint8_t *output)
+{
+    // a cut snapshot would pass for the whole one
+    if (length > DELTA_SNAPSHOT_LENGTH) {
+        return 0;
+    }
+
+    uint8_t last = base_ ^ 1;
+
+    if (ackId != 0 && ackId == ids_[last]) {
+        // master confirmed the last snapshot sent
+        base_ = last;
+        last = base_ ^ 1;
+    }
+    else if (ackId == 0 || ackId != ids_[base_]) {
+        ids_[base_] = 0;
+    }
+
+    // ids wrap from 255 to 1, 0 means none
+    lastId_ = lastId_ == 255 ? 1 : lastId_ + 1;
+
+    memcpy(snapshots_[last], data, length);
+    lengths_[last] = length;
+    ids_[last] = lastId_;
+
+    size_t full = length + 2;
+
+    if (ids_[base_] != 0) {
+        const uint8_t *base = snapshots_[base_];
+        size_t baseLength = lengths_[base_];
+
+        output[0] = DELTA_PATCH;
+        output[1] = ids_[base_];
+        output[2] = lastId_;
+        output[3] = length;
+        size_t out = 4;
+
+        size_t i = 0;
+        while (i < length && out < full) {
+            if (i < baseLength && data[i] == base[i]) {
+                ++i;
+                continue;
+            }
+
+            // extend the range over short runs of unchanged bytes
+            size_t end = i + 1;
+            size_t same = 0;
+            while (end < length && same <= DELTA_RANGE_GAP) {
+                if (end < baseLength && data[end] == base[end]) {
+                    ++same;
+                }
+                else {
+                    same = 0;
+                }
+                ++end;
+            }
+            end -= same;
+
+            size_t rangeLength = end - i;
+            if (out + 2 + rangeLength >= full) {
+                out = full;
+                break;
+            }
+
+            output[out] = i;
+            output[out + 1] = rangeLength;
+            memcpy(output + out + 2, data + i, rangeLength);
+            out += 2 + rangeLength;
+            i = end;
+        }
+
+        if (out < full) {
+            return out;
+        }
+    }
+
+    output[0] = DELTA_FULL;
+    output[1] = lastId_;
+    memcpy(output + 2, data, length);
+    return full;
+}
+
+void WireDeltaEncoder::reset()
+{
+    base_ = 0;
+    lengths_[0] = lengths_[1] = 0;
+    ids_[0] = ids_[1] = 0;
+}
+
+WireDeltaDecoder::WireDeltaDecoder()
+    :length_(0)
+    ,id_(0)
+{
+}
+
+bool WireDeltaDecoder::decode(const uint8_t *data, size_t length)
+{
+    if (length >= 2 && data[0] == DELTA_FULL) {
+        length -= 2;
+        if (length > DELTA_SNAPSHOT_LENGTH) {
+            reset();
+            return false;
+        }
+
+        memcpy(snapshot_, data + 2, length);
+        length_ = length;
+        id_ = data[1];
+        return true;
+    }
+
+    if (length < 4 || data[0] != DELTA_PATCH || data[1] != id_ || id_ == 0
+            || data[3] > DELTA_SNAPSHOT_LENGTH) {
+        reset();
+        return false;
+    }
+
+    // check every range before changing the snapshot
+    size_t newLength = data[3];
+    size_t i = 4;
+    while (i < length) {
+        if (i + 2 > length || data[i] + data[i + 1] > newLength
+                || i + 2 + data[i + 1] > length) {
+            reset();
+            return false;
+        }
+        i += 2 + data[i + 1];
+    }
+
+    i = 4;
+    while (i < length) {
+        memcpy(snapshot_ + data[i], data + i + 2, data[i + 1]);
+        i += 2 + data[i + 1];
+    }
+
+    length_ = newLength;
+    id_ = data[2];
+    return true;
+}
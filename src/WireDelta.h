@@ -0,0 +1,122 @@
+/**
+ * @file WireDelta.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Delta encoding of slave responses
+ * @date 2026-10-18
+ * 
+ * When a slave answers every request with a mostly unchanged
+ * block of data, WireDeltaEncoder (slave) and WireDeltaDecoder
+ * (master) send only the bytes that changed since the last
+ * response the master confirmed.
+ * 
+ * Each response is a snapshot with an ID. The master sends the
+ * ID of the last snapshot it holds inside its request, and the
+ * slave encodes the new response against that snapshot. If the
+ * slave doesn't have it anymore, the full snapshot is sent.
+ * 
+ * Encoded payload formats:
+ *      full:   [0]: DELTA_FULL, [1]: id, [2..]: snapshot
+ *      delta:  [0]: DELTA_PATCH, [1]: base id, [2]: id,
+ *              [3]: snapshot length, then ranges of changed bytes,
+ *              each one as offset, length and bytes
+ *      none:   [0]: DELTA_NONE, the snapshot didn't fit a packet
+ * 
+ * Snapshots are limited to DELTA_SNAPSHOT_LENGTH bytes, and to the
+ * packet payload minus 2 bytes when sent (see TwoWireSlave::setDelta()).
+ * 
+ */
+#ifndef WireDelta_h
+#define WireDelta_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// packet payload, minus the full snapshot header
+#define DELTA_SNAPSHOT_LENGTH 122
+
+#define DELTA_FULL 0
+#define DELTA_PATCH 1
+#define DELTA_NONE 2
+
+class WireDeltaEncoder
+{
+public:
+    WireDeltaEncoder();
+
+    /**
+     * Encodes a new snapshot against the one the master holds,
+     * and keeps it until the master confirms it.
+     * 
+     * @param ackId     ID of the snapshot the master holds, 0 if none
+     * @param data      new snapshot
+     * @param length    snapshot length, up to DELTA_SNAPSHOT_LENGTH
+     * @param output    encoded payload, DELTA_SNAPSHOT_LENGTH + 2 bytes
+     * @return size_t   encoded payload length, at most length + 2;
+     *                  0 if the snapshot is too long, nothing kept
+     */
+    size_t encode(uint8_t ackId, const uint8_t *data, size_t length, uint8_t *output);
+
+    /**
+     * Forgets both snapshots, so the next one is sent in full.
+     */
+    void reset();
+
+private:
+    // snapshot the master confirmed (base) and the last one sent
+    uint8_t snapshots_[2][DELTA_SNAPSHOT_LENGTH];
+    uint8_t lengths_[2];
+    uint8_t ids_[2];
+    uint8_t base_;
+    uint8_t lastId_;
+};
+
+class WireDeltaDecoder
+{
+public:
+    WireDeltaDecoder();
+
+    /**
+     * ID of the snapshot held, sent to the slave with each request.
+     */
+    uint8_t ackId() const
+    {
+        return id_;
+    }
+
+    /**
+     * Applies an encoded payload to the held snapshot.
+     * 
+     * @param data      encoded payload
+     * @param length    encoded payload length
+     * @return true     snapshot updated
+     * @return false    invalid payload, DELTA_NONE or unknown base
+     *                  snapshot; the next request will get a full one
+     */
+    bool decode(const uint8_t *data, size_t length);
+
+    const uint8_t *snapshot() const
+    {
+        return snapshot_;
+    }
+
+    size_t length() const
+    {
+        return length_;
+    }
+
+    /**
+     * Drops the held snapshot, so the next one is requested in full.
+     */
+    void reset()
+    {
+        id_ = 0;
+        length_ = 0;
+    }
+
+private:
+    uint8_t snapshot_[DELTA_SNAPSHOT_LENGTH];
+    uint8_t length_;
+    uint8_t id_;
+};
+
+#endif
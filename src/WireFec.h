@@ -0,0 +1,105 @@
+/**
+ * @file WireFec.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Hamming SECDED code used by WirePacker and WireUnpacker
+ * @date 2026-10-18
+ * 
+ * Each byte is sent as two codewords, one per nibble, of the
+ * extended Hamming(8,4) code: a single flipped bit in a codeword
+ * is corrected, two flipped bits are detected.
+ * 
+ * Codeword bits: p1 p2 d1 p3 d2 d3 d4 p, where p1..p3 are the
+ * Hamming parity bits and p is the parity of the other seven.
+ */
+
+#ifndef WireFec_h
+#define WireFec_h
+
+#include <stdint.h>
+
+class WireFec
+{
+public:
+    /**
+     * Encodes a byte into two codewords, low nibble first.
+     * 
+     * @param data  byte to be encoded
+     * @param code  destination, 2 bytes
+     */
+    static void encode(uint8_t data, uint8_t *code)
+    {
+        code[0] = encodeNibble(data & 0x0F);
+        code[1] = encodeNibble(data >> 4);
+    }
+
+    /**
+     * Decodes two codewords into a byte, correcting them if needed.
+     * 
+     * @param code      codewords, 2 bytes
+     * @param data      decoded byte
+     * @return int      number of corrected bits, or -1 if
+     *                  the byte could not be corrected
+     */
+    static int decode(const uint8_t *code, uint8_t &data)
+    {
+        uint8_t low;
+        uint8_t high;
+        int lowFixed = decodeNibble(code[0], low);
+        int highFixed = decodeNibble(code[1], high);
+
+        if (lowFixed < 0 || highFixed < 0) {
+            return -1;
+        }
+
+        data = low | (high << 4);
+        return lowFixed + highFixed;
+    }
+
+private:
+    static uint8_t encodeNibble(uint8_t nibble)
+    {
+        uint8_t d1 = nibble & 1;
+        uint8_t d2 = (nibble >> 1) & 1;
+        uint8_t d3 = (nibble >> 2) & 1;
+        uint8_t d4 = (nibble >> 3) & 1;
+
+        uint8_t code = (d1 ^ d2 ^ d4)
+                | ((d1 ^ d3 ^ d4) << 1)
+                | (d1 << 2)
+                | ((d2 ^ d3 ^ d4) << 3)
+                | (d2 << 4)
+                | (d3 << 5)
+                | (d4 << 6);
+
+        return code | (__builtin_parity(code) << 7);
+    }
+
+    static int decodeNibble(uint8_t code, uint8_t &nibble)
+    {
+        // bit position (1 to 7) of a single error, 0 if none
+        uint8_t syndrome = __builtin_parity(code & 0x55)
+                | (__builtin_parity(code & 0x66) << 1)
+                | (__builtin_parity(code & 0x78) << 2);
+        int fixed = 0;
+
+        if (__builtin_parity(code)) {
+            // odd number of flipped bits, assume one
+            if (syndrome) {
+                code ^= 1 << (syndrome - 1);
+            }
+            fixed = 1;
+        }
+        else if (syndrome) {
+            // two flipped bits
+            return -1;
+        }
+
+        nibble = ((code >> 2) & 1)
+                | ((code >> 3) & 2)
+                | ((code >> 3) & 4)
+                | ((code >> 3) & 8);
+        return fixed;
+    }
+};
+
+#endif
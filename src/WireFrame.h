@@ -0,0 +1,157 @@
+/**
+ * @file WireFrame.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Packet types used by WirePacker and WireUnpacker
+ * @date 2026-10-18
+ * 
+ * The first byte of every packet (start byte) tells what the
+ * packet is for. Packets from previous versions always start
+ * with 0x02 (data), so they keep working unchanged.
+ * 
+ * Packets can be framed in two ways, and both sides must use
+ * the same one:
+ * 
+ * FRAMING_STX, the default: start byte, length, payload, CRC,
+ * and the 0x04 end byte.
+ * 
+ * FRAMING_COBS: start byte, length, payload and CRC encoded with
+ * COBS (Consistent Overhead Byte Stuffing), which removes every
+ * 0x00 byte, followed by a 0x00 delimiter. As 0x00 only appears at
+ * the end of a packet, the receiver finds the next packet with a
+ * single scan and a broken packet never hides the following one.
+ * It costs one byte more than FRAMING_STX, so the payload is
+ * limited to one byte less.
+ * 
+ * The CRC is 8 bits wide by default. The two upper bits of the
+ * start byte select a wider one (WireCrcWidth), sent least
+ * significant byte first: CRC_16 (CRC-16/X-25) takes two bytes,
+ * CRC_32 (the CRC-32 of zlib and Ethernet) four. A random error
+ * then goes unnoticed once in 65536 or 4294967296 packets, instead
+ * of once in 256. Receivers detect the width from the start byte,
+ * senders choose it with setCrc().
+ * 
+ */
+#ifndef WireFrame_h
+#define WireFrame_h
+
+#include <stdint.h>
+
+enum WireFrameType : uint8_t
+{
+    // data packet (STX), an empty one also triggers onRequest()
+    FRAME_DATA = 0x02,
+
+    // response request (ENQ), payload holds the endpoint; an empty
+    // one retries a request whose response arrived broken
+    FRAME_REQUEST = 0x05,
+
+    // data packet the slave answers with FRAME_ACK or FRAME_NAK
+    FRAME_WRITE = 0x11,
+
+    // data packet sent to the general call address (SOH)
+    FRAME_BROADCAST = 0x01,
+
+    // answers to a FRAME_WRITE (ACK and NAK), payload holds its
+    // CRC, see WireSlaveWrite.h
+    FRAME_ACK = 0x06,
+    FRAME_NAK = 0x15,
+
+    // bulk transfer chunk (ETB), payload holds a 32-bit offset
+    // and the data, see WireBulkWrite.h
+    FRAME_CHUNK = 0x17,
+
+    // clock synchronization (SYN), payload holds timestamps,
+    // see WireTimeSync.h
+    FRAME_SYNC = 0x16,
+};
+
+// start byte bits holding the CRC width
+#define WIRE_CRC_MASK 0xC0
+
+enum WireCrcWidth : uint8_t
+{
+    CRC_8 = 0x00,
+    CRC_16 = 0x40,
+    CRC_32 = 0x80,
+};
+
+enum WireFraming : uint8_t
+{
+    FRAMING_STX = 0,
+    FRAMING_COBS,
+};
+
+/**
+ * Returns the number of CRC bytes of a packet.
+ */
+inline uint8_t wireCrcLength(WireCrcWidth crc)
+{
+    return crc == CRC_32 ? 4 : (crc == CRC_16 ? 2 : 1);
+}
+
+/**
+ * Returns the length byte of a packet: start, length, payload,
+ * CRC and end bytes. With forward error correction (WireFec.h)
+ * payload and CRC bytes take two bytes each.
+ * 
+ * @param payloadLength number of payload bytes
+ * @param fec           true if FEC is enabled
+ * @param crc           CRC width
+ */
+inline uint8_t wirePacketLength(uint8_t payloadLength, bool fec, WireCrcWidth crc = CRC_8)
+{
+    uint8_t length = payloadLength + wireCrcLength(crc);
+    return fec ? 2 * length + 3 : length + 3;
+}
+
+/**
+ * Returns how many bytes a packet takes on the wire.
+ * 
+ * @param packetLength  value of the length byte (see wirePacketLength())
+ * @param framing       framing used
+ */
+inline uint8_t wireFrameLength(uint8_t packetLength, WireFraming framing)
+{
+    return framing == FRAMING_COBS ? packetLength + 1 : packetLength;
+}
+
+/**
+ * Returns true if the byte is the start byte of a known packet type,
+ * with any CRC width.
+ * 
+ */
+inline bool isWireFrameType(uint8_t data)
+{
+    if ((data & WIRE_CRC_MASK) == WIRE_CRC_MASK) {
+        return false;
+    }
+
+    switch (data & ~WIRE_CRC_MASK) {
+    case FRAME_DATA:
+    case FRAME_BROADCAST:
+    case FRAME_REQUEST:
+    case FRAME_WRITE:
+    case FRAME_ACK:
+    case FRAME_NAK:
+    case FRAME_CHUNK:
+    case FRAME_SYNC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Splits a start byte into packet type and CRC width.
+ */
+inline WireFrameType wireFrameType(uint8_t data)
+{
+    return WireFrameType(data & ~WIRE_CRC_MASK);
+}
+
+inline WireCrcWidth wireCrcWidth(uint8_t data)
+{
+    return WireCrcWidth(data & WIRE_CRC_MASK);
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file WireLinuxTransport.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief WireTransport for Linux i2c-dev devices
+ * @date 2026-10-18
+ *
+ */
+#include "WireLinuxTransport.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+WireLinuxTransport::WireLinuxTransport()
+    :fd_(-1)
+{
+}
+
+WireLinuxTransport::~WireLinuxTransport()
+{
+    end();
+}
+
+bool WireLinuxTransport::begin(const char *device)
+{
+    end();
+    fd_ = open(device, O_RDWR);
+    return fd_ >= 0;
+}
+
+bool WireLinuxTransport::begin(int bus)
+{
+    char device[20];
+    snprintf(device, sizeof(device), "/dev/i2c-%d", bus);
+    return begin(device);
+}
+
+void WireLinuxTransport::end()
+{
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool WireLinuxTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+    struct i2c_msg message;
+    message.addr = address;
+    message.flags = 0;
+    message.len = length;
+    message.buf = (uint8_t*) data;
+
+    struct i2c_rdwr_ioctl_data transfer = { &message, 1 };
+    return ioctl(fd_, I2C_RDWR, &transfer) == 1;
+}
+
+size_t WireLinuxTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+    struct i2c_msg message;
+    message.addr = address;
+    message.flags = I2C_M_RD;
+    message.len = length;
+    message.buf = data;
+
+    struct i2c_rdwr_ioctl_data transfer = { &message, 1 };
+    if (ioctl(fd_, I2C_RDWR, &transfer) != 1) {
+        return 0;
+    }
+    return length;
+}
+
+size_t WireLinuxTransport::writeRead(uint8_t address, const uint8_t *output,
+        size_t outputLength, uint8_t *input, size_t inputLength)
+{
+    // write, repeated start and read in one kernel call
+    struct i2c_msg messages[2];
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = outputLength;
+    messages[0].buf = (uint8_t*) output;
+    messages[1].addr = address;
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = inputLength;
+    messages[1].buf = input;
+
+    struct i2c_rdwr_ioctl_data transfer = { messages, 2 };
+    if (ioctl(fd_, I2C_RDWR, &transfer) != 2) {
+        return 0;
+    }
+    return inputLength;
+}
+
+void WireLinuxTransport::delay(unsigned long ms)
+{
+    struct timespec duration;
+    duration.tv_sec = ms / 1000;
+    duration.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&duration, NULL);
+}
+
+uint32_t WireLinuxTransport::micros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint32_t(now.tv_sec) * 1000000UL + now.tv_nsec / 1000;
+}
+
+#endif      // if defined(__linux__) && !defined(ARDUINO)
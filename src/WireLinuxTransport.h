@@ -0,0 +1,71 @@
+/**
+ * @file WireLinuxTransport.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief WireTransport for Linux i2c-dev devices
+ * @date 2026-10-18
+ *
+ * Lets a Linux board (Raspberry Pi and the like) be the master of
+ * ESP32 slaves, with the same WireSlaveRequest and WireSlaveWrite
+ * classes. Every transaction is a single ioctl(I2C_RDWR) call, and
+ * writeRead() sends the request and reads the answer with a
+ * repeated start in that same call.
+ *
+ * Build the library sources (without Arduino) with the program:
+ *
+ *      WireLinuxTransport bus;
+ *      if (!bus.begin(1)) { ... }      // opens /dev/i2c-1
+ *      WireSlaveRequest slaveReq(bus, 0x04, 32);
+ *      if (slaveReq.request()) { ... }
+ *
+ */
+#ifndef WireLinuxTransport_h
+#define WireLinuxTransport_h
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "WireTransport.h"
+
+class WireLinuxTransport : public WireTransport
+{
+public:
+    WireLinuxTransport();
+    ~WireLinuxTransport();
+
+    /**
+     * Opens the i2c-dev device.
+     *
+     * @param device    device path, like "/dev/i2c-1"
+     * @return true     device opened
+     */
+    bool begin(const char *device);
+
+    /**
+     * Opens /dev/i2c-<bus>.
+     *
+     * @param bus       bus number
+     * @return true     device opened
+     */
+    bool begin(int bus);
+
+    /**
+     * Closes the device.
+     */
+    void end();
+
+    bool write(uint8_t address, const uint8_t *data, size_t length);
+    size_t read(uint8_t address, uint8_t *data, size_t length);
+    size_t writeRead(uint8_t address, const uint8_t *output, size_t outputLength,
+            uint8_t *input, size_t inputLength);
+    void delay(unsigned long ms);
+    uint32_t micros();
+
+private:
+    int fd_;
+
+    WireLinuxTransport(const WireLinuxTransport&);
+    WireLinuxTransport &operator=(const WireLinuxTransport&);
+};
+
+#endif      // if defined(__linux__) && !defined(ARDUINO)
+
+#endif
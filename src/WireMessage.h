@@ -0,0 +1,270 @@
+/**
+ * @file WireMessage.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Fixed layout messages declared from a field list
+ * @date 2026-10-18
+ *
+ * Declares message structs from X-macro field lists, with encoders
+ * and decoders whose length is known at compile time, instead of
+ * hand written write()/read() sequences or printf() and parsing.
+ *
+ * A message list names each message, its ID and its fields:
+ *
+ *      #define SENSOR_READING(FIELD) \
+ *          FIELD(int16_t, temperature) \
+ *          FIELD(uint16_t, humidity)
+ *
+ *      #define SET_LED(FIELD) \
+ *          FIELD(uint8_t, led) \
+ *          FIELD(bool, on)
+ *
+ *      #define MESSAGES(MESSAGE) \
+ *          MESSAGE(SensorReading, 0x20, SENSOR_READING) \
+ *          MESSAGE(SetLed, 0x21, SET_LED)
+ *
+ *      WIRE_MESSAGES(Messages, MESSAGES)
+ *
+ * which declares the structs SensorReading and SetLed, and the
+ * catalog Messages. Sender and receiver must use the same list, in a
+ * header shared by both sketches for instance. A single message can
+ * also be declared with WIRE_MESSAGE(SetLed, 0x21, SET_LED).
+ *
+ * Payload layout: [0] message ID, then the fields in order, little
+ * endian. Field types are bool, char, int8_t to int64_t, uint8_t to
+ * uint64_t and float (see WireFieldSize).
+ *
+ * Every message struct has:
+ *      ID, LENGTH: message ID and payload length, as constants
+ *      encode(data): writes the LENGTH payload bytes to data
+ *      decode(data, length): reads the fields, false if the ID or
+ *          the length doesn't match
+ *      writeTo(output): adds the payload to a WirePacker,
+ *          WireSlaveWrite or TwoWireSlave (inside onRequest()), or
+ *          nothing if it doesn't fit, returning 0
+ *      readFrom(input): reads the payload from WireSlaveRequest,
+ *          WireUnpacker or TwoWireSlave (inside onReceive())
+ *
+ * The catalog dispatches a payload by its ID to the handler overload
+ * taking that message, with a switch, so repeated IDs don't compile:
+ *
+ *      struct Handler {
+ *          void onMessage(const SetLed &message) { ... }
+ *          void onMessage(const SensorReading &message) { ... }
+ *      };
+ *      Handler handler;
+ *      Messages::dispatch(handler, WireSlave);   // inside onReceive()
+ *
+ * The ID takes the first payload byte, like an endpoint ID, so
+ * messages don't go to a slave that has endpoints registered.
+ *
+ * LENGTH is checked at compile time against the payload of a
+ * packet with the default settings. COBS, wider CRCs, FEC and slave
+ * timestamps leave less room, which writeTo() checks when sending.
+ *
+ */
+#ifndef WireMessage_h
+#define WireMessage_h
+
+#include <stdint.h>
+#include <string.h>
+#include "WirePacker.h"
+
+// longest payload of a packet with FRAMING_STX, CRC_8 and no FEC
+#define WIREMESSAGE_MAX_LENGTH (PACKER_BUFFER_LENGTH - 4)
+
+/**
+ * Length of a field type on the wire, and the unsigned type holding
+ * its bits. Types without a specialization can't be message fields.
+ */
+template<typename T> struct WireFieldSize;
+
+#define WIRE_FIELD_TYPE(type, bitsType) \
+template<> struct WireFieldSize<type> \
+{ \
+    typedef bitsType Bits; \
+    enum { value = sizeof(bitsType) }; \
+};
+
+WIRE_FIELD_TYPE(bool, uint8_t)
+WIRE_FIELD_TYPE(char, uint8_t)
+WIRE_FIELD_TYPE(int8_t, uint8_t)
+WIRE_FIELD_TYPE(uint8_t, uint8_t)
+WIRE_FIELD_TYPE(int16_t, uint16_t)
+WIRE_FIELD_TYPE(uint16_t, uint16_t)
+WIRE_FIELD_TYPE(int32_t, uint32_t)
+WIRE_FIELD_TYPE(uint32_t, uint32_t)
+WIRE_FIELD_TYPE(int64_t, uint64_t)
+WIRE_FIELD_TYPE(uint64_t, uint64_t)
+WIRE_FIELD_TYPE(float, uint32_t)
+
+#undef WIRE_FIELD_TYPE
+
+template<typename T>
+inline void wireFieldPut(uint8_t *&out, T value)
+{
+    typename WireFieldSize<T>::Bits bits = value;
+    for (uint8_t i = 0; i < WireFieldSize<T>::value; ++i) {
+        out[i] = uint8_t(bits >> (8 * i));
+    }
+    out += WireFieldSize<T>::value;
+}
+
+inline void wireFieldPut(uint8_t *&out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    wireFieldPut(out, bits);
+}
+
+template<typename T>
+inline void wireFieldGet(const uint8_t *&in, T &value)
+{
+    typename WireFieldSize<T>::Bits bits = 0;
+    for (uint8_t i = 0; i < WireFieldSize<T>::value; ++i) {
+        bits |= typename WireFieldSize<T>::Bits(in[i]) << (8 * i);
+    }
+    value = T(bits);
+    in += WireFieldSize<T>::value;
+}
+
+inline void wireFieldGet(const uint8_t *&in, float &value)
+{
+    uint32_t bits;
+    wireFieldGet(in, bits);
+    memcpy(&value, &bits, sizeof(value));
+}
+
+#define WIRE_FIELD_MEMBER(type, name) type name;
+#define WIRE_FIELD_LENGTH(type, name) + WireFieldSize<type>::value
+#define WIRE_FIELD_PUT(type, name) wireFieldPut(out, name);
+#define WIRE_FIELD_GET(type, name) wireFieldGet(in, name);
+
+/**
+ * Declares the struct of a single message.
+ *
+ * @param Name      struct name
+ * @param messageId first payload byte
+ * @param FIELDS    field list macro, taking FIELD(type, name)
+ */
+#define WIRE_MESSAGE(Name, messageId, FIELDS) \
+struct Name \
+{ \
+    enum \
+    { \
+        ID = messageId, \
+        LENGTH = 1 FIELDS(WIRE_FIELD_LENGTH), \
+    }; \
+    static_assert(LENGTH <= WIREMESSAGE_MAX_LENGTH, #Name " doesn't fit a packet"); \
+    \
+    FIELDS(WIRE_FIELD_MEMBER) \
+    \
+    size_t encode(uint8_t *data) const \
+    { \
+        uint8_t *out = data; \
+        *out++ = ID; \
+        FIELDS(WIRE_FIELD_PUT) \
+        return LENGTH; \
+    } \
+    \
+    bool decode(const uint8_t *data, size_t length) \
+    { \
+        if (length != LENGTH || data[0] != ID) { \
+            return false; \
+        } \
+        const uint8_t *in = data + 1; \
+        FIELDS(WIRE_FIELD_GET) \
+        (void) in; \
+        return true; \
+    } \
+    \
+    template<typename Output> \
+    size_t writeTo(Output &output) const \
+    { \
+        if (output.room() < LENGTH) { \
+            return 0; \
+        } \
+        uint8_t data[LENGTH]; \
+        encode(data); \
+        return output.write(data, LENGTH); \
+    } \
+    \
+    template<typename Input> \
+    bool readFrom(Input &input) \
+    { \
+        if (input.available() < LENGTH) { \
+            return false; \
+        } \
+        uint8_t data[LENGTH]; \
+        for (uint8_t i = 0; i < LENGTH; ++i) { \
+            data[i] = input.read(); \
+        } \
+        return decode(data, LENGTH); \
+    } \
+};
+
+#define WIRE_MESSAGE_BUFFER(Name, messageId, FIELDS) uint8_t Name##_[Name::LENGTH];
+
+#define WIRE_MESSAGE_CASE(Name, messageId, FIELDS) \
+    case messageId: \
+    { \
+        Name message; \
+        if (!message.decode(data, length)) { \
+            return false; \
+        } \
+        handler.onMessage(message); \
+        return true; \
+    }
+
+/**
+ * Declares the structs of a message list, and a catalog struct
+ * dispatching payloads to a handler.
+ *
+ * @param Catalog   catalog struct name
+ * @param MESSAGES  message list macro, taking MESSAGE(Name, id, FIELDS)
+ */
+#define WIRE_MESSAGES(Catalog, MESSAGES) \
+MESSAGES(WIRE_MESSAGE) \
+\
+struct Catalog \
+{ \
+    union Buffer \
+    { \
+        MESSAGES(WIRE_MESSAGE_BUFFER) \
+    }; \
+    \
+    enum \
+    { \
+        MAX_LENGTH = sizeof(Buffer), \
+    }; \
+    \
+    template<typename Handler> \
+    static bool dispatch(Handler &handler, const uint8_t *data, size_t length) \
+    { \
+        if (length == 0) { \
+            return false; \
+        } \
+        switch (data[0]) { \
+        MESSAGES(WIRE_MESSAGE_CASE) \
+        default: \
+            return false; \
+        } \
+    } \
+    \
+    template<typename Handler, typename Input> \
+    static bool dispatch(Handler &handler, Input &input) \
+    { \
+        uint8_t data[MAX_LENGTH]; \
+        size_t length = 0; \
+        while (input.available() > 0) { \
+            /* longer payloads are read out, and fail to decode */ \
+            uint8_t c = input.read(); \
+            if (length < MAX_LENGTH) { \
+                data[length] = c; \
+            } \
+            ++length; \
+        } \
+        return dispatch(handler, data, length); \
+    } \
+};
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file WireNotifier.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Tracks the data-ready lines of the slaves on the master
+ * @date 2026-10-18
+ *
+ */
+#include "WireNotifier.h"
+#include "WireSlaveRequest.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+static bool digitalReadLine(uint8_t line)
+{
+    return digitalRead(line) == HIGH;
+}
+#endif
+
+WireNotifier::WireNotifier(bool (*readLine)(uint8_t line))
+    :readLine_(readLine)
+    ,slaves_()
+    ,slaveCount_(0)
+    ,pending_()
+    ,lastAddress_(0)
+{
+#ifdef ARDUINO
+    if (readLine_ == nullptr) {
+        readLine_ = digitalReadLine;
+    }
+#endif
+}
+
+bool WireNotifier::add(uint8_t address, uint8_t line, bool activeLow)
+{
+    if (slaveCount_ == WIRENOTIFIER_SLAVES) {
+        return false;
+    }
+
+    slaves_[slaveCount_].address = address & 0x7F;
+    slaves_[slaveCount_].line = line;
+    slaves_[slaveCount_].activeLow = activeLow;
+    ++slaveCount_;
+    return true;
+}
+
+uint8_t WireNotifier::update()
+{
+    if (readLine_) {
+        for (uint8_t i = 0; i < slaveCount_; ++i) {
+            if (readLine_(slaves_[i].line) != slaves_[i].activeLow) {
+                setPending(slaves_[i].address);
+            }
+        }
+    }
+    return pendingCount();
+}
+
+void WireNotifier::setPending(uint8_t address)
+{
+    address &= 0x7F;
+    pending_[address / 32] |= uint32_t(1) << (address % 32);
+}
+
+bool WireNotifier::isPending(uint8_t address) const
+{
+    address &= 0x7F;
+    return pending_[address / 32] & (uint32_t(1) << (address % 32));
+}
+
+uint8_t WireNotifier::pendingCount() const
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        for (uint32_t bits = pending_[i]; bits != 0; bits &= bits - 1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+uint8_t WireNotifier::next()
+{
+    // start after the last one taken
+    for (uint8_t i = 1; i <= 128; ++i) {
+        uint8_t address = (lastAddress_ + i) & 0x7F;
+
+        if (address != 0 && isPending(address)) {
+            pending_[address / 32] &= ~(uint32_t(1) << (address % 32));
+            lastAddress_ = address;
+            return address;
+        }
+    }
+    return 0;
+}
+
+uint8_t WireNotifier::requestPending(WireSlaveRequest &request,
+        void (*onResponse)(uint8_t address, WireSlaveRequest &request))
+{
+    update();
+
+    uint8_t count = 0;
+    uint8_t address;
+    while ((address = next()) != 0) {
+        if (request.request(address)) {
+            onResponse(address, request);
+            ++count;
+        }
+    }
+    return count;
+}
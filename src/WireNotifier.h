@@ -0,0 +1,126 @@
+/**
+ * @file WireNotifier.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Tracks the data-ready lines of the slaves on the master
+ * @date 2026-10-18
+ *
+ * An I2C slave can't start a transfer, so without help the master
+ * polls every slave. With TwoWireSlave::setDataReadyPin(), a slave
+ * asserts a GPIO line when it has something new (notify()), and
+ * releases it when the master requests it. WireNotifier samples those
+ * lines and keeps a bitmap of the pending slaves, so only they are
+ * requested:
+ *
+ *      WireNotifier notifier;
+ *      notifier.add(0x04, 16);     // slave 0x04 on GPIO 16
+ *      notifier.add(0x05, 17);
+ *      ...
+ *      notifier.update();
+ *      uint8_t address;
+ *      while ((address = notifier.next()) != 0) {
+ *          if (slaveReq.request(address)) { ... }
+ *      }
+ *
+ * or requestPending(), which does the same with a callback.
+ *
+ * Slaves may share an active low (open drain) line, which marks
+ * all of them pending when asserted.
+ *
+ * Lines are read with digitalRead() on Arduino, or with the function
+ * given to the constructor, which may as well read a simulated GPIO
+ * in a host test, along with a simulated WireTransport.
+ *
+ */
+#ifndef WireNotifier_h
+#define WireNotifier_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef WIRENOTIFIER_SLAVES
+#define WIRENOTIFIER_SLAVES 16
+#endif
+
+class WireSlaveRequest;
+
+class WireNotifier
+{
+public:
+    /**
+     * Construct a new WireNotifier object
+     *
+     * @param readLine  returns true if a line is high; nullptr for
+     *                  digitalRead() on Arduino, elsewhere lines are
+     *                  not read and only setPending() marks slaves
+     */
+    WireNotifier(bool (*readLine)(uint8_t line) = nullptr);
+
+    /**
+     * Adds a slave and its data-ready line.
+     *
+     * @param address   7-bit slave address
+     * @param line      GPIO number
+     * @param activeLow true if the line is asserted low
+     * @return true     added, false if WIRENOTIFIER_SLAVES are added
+     */
+    bool add(uint8_t address, uint8_t line, bool activeLow = true);
+
+    /**
+     * Reads the lines, and marks the slaves with asserted ones
+     * as pending.
+     *
+     * @return uint8_t  number of pending slaves
+     */
+    uint8_t update();
+
+    /**
+     * Marks a slave as pending, as if its line were asserted.
+     */
+    void setPending(uint8_t address);
+
+    bool isPending(uint8_t address) const;
+
+    uint8_t pendingCount() const;
+
+    /**
+     * Takes the next pending slave, in turns, so every one is
+     * served even if another one keeps notifying.
+     *
+     * @return uint8_t  slave address, or 0 if none is pending
+     */
+    uint8_t next();
+
+    /**
+     * @brief Calls update(), then requests from every pending slave
+     * and hands each response to the callback.
+     *
+     * A failed request is not retried here. Its slave asserts the
+     * line again when request() retries after a broken read, so it
+     * is requested again after the next update(); a slave that
+     * didn't answer at all is not.
+     *
+     * @param request       request object, its address is changed
+     * @param onResponse    called with the address of each slave read
+     * @return uint8_t      number of slaves read
+     */
+    uint8_t requestPending(WireSlaveRequest &request,
+            void (*onResponse)(uint8_t address, WireSlaveRequest &request));
+
+private:
+    struct Slave
+    {
+        uint8_t address;
+        uint8_t line;
+        bool activeLow;
+    };
+
+    bool (*readLine_)(uint8_t);
+    Slave slaves_[WIRENOTIFIER_SLAVES];
+    uint8_t slaveCount_;
+
+    // one bit for each 7-bit address
+    uint32_t pending_[4];
+    uint8_t lastAddress_;
+};
+
+#endif
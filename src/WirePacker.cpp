@@ -6,10 +6,17 @@
  * 
  */
 
+#include <math.h>
+#include <stdio.h>
 #include "WirePacker.h"
 #include "WireCrc.h"
+#include "WireFec.h"
 
 WirePacker::WirePacker()
+    :framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,crc_(0)
 {
     reset();
 }
@@ -20,8 +27,9 @@ size_t WirePacker::write(uint8_t data)
         return 0;
     }
 
-    // leave room for crc and end bytes
-    if (totalLength_ >= PACKER_BUFFER_LENGTH - 2) {
+    // leave room for crc and end bytes, each byte
+    // takes two with fec
+    if (packetLength() + (isFecEnabled_ ? 2 : 1) > PACKER_BUFFER_LENGTH) {
         return 0;
     }
 
@@ -34,39 +42,206 @@ size_t WirePacker::write(uint8_t data)
 
 size_t WirePacker::write(const uint8_t *data, size_t quantity)
 {
-    for (size_t i = 0; i < quantity; ++i) {
-        if (!write(data[i])) {
-            return i;
-        }
+    size_t space = room();
+    if (quantity > space) {
+        quantity = space;
     }
+
+    memcpy(buffer_ + index_, data, quantity);
+    index_ += quantity;
+    totalLength_ = index_;
+
     return quantity;
 }
 
-void WirePacker::end()
+size_t WirePacker::writeDecimal(long value)
 {
-    isPacketOpen_ = false;
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value : value;
+    return writeNumber(magnitude, value < 0, 0);
+}
 
-    // make room for CRC byte
-    ++index_;
+size_t WirePacker::writeDecimal(unsigned long value)
+{
+    return writeNumber(value, false, 0);
+}
 
-    buffer_[index_] = frameEnd_;
-    ++index_;
+size_t WirePacker::writeFixed(long value, uint8_t decimals)
+{
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value : value;
+    return writeNumber(magnitude, value < 0, decimals);
+}
+
+size_t WirePacker::writeFloat(double value, uint8_t decimals)
+{
+    // same limits as Print
+    if (isnan(value)) {
+        return write("nan");
+    }
+    if (isinf(value)) {
+        return write("inf");
+    }
+    if (value > 4294967040.0 || value < -4294967040.0) {
+        return write("ovf");
+    }
+
+    bool isNegative = value < 0;
+    if (isNegative) {
+        value = -value;
+    }
+
+    double scale = 1;
+    for (uint8_t i = 0; i < decimals; ++i) {
+        scale *= 10;
+    }
+
+    // drop decimals that would overflow the integer
+    while (decimals > 0 && value * scale + 0.5 > 4294967295.0) {
+        scale /= 10;
+        --decimals;
+    }
+
+    unsigned long magnitude = (unsigned long) (value * scale + 0.5);
+    return writeNumber(magnitude, isNegative && magnitude != 0, decimals);
+}
+
+size_t WirePacker::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t count = vprintf(format, args);
+    va_end(args);
+    return count;
+}
+
+size_t WirePacker::vprintf(const char *format, va_list args)
+{
+    size_t space = room();
+    if (space == 0) {
+        return 0;
+    }
+
+    // crc and end bytes are always free, so the terminating
+    // null still fits after the last payload byte
+    int length = vsnprintf((char *) buffer_ + index_, space + 1, format, args);
+    if (length <= 0) {
+        return 0;
+    }
+
+    size_t count = (size_t) length < space ? length : space;
+    index_ += count;
+    totalLength_ = index_;
+    return count;
+}
+
+size_t WirePacker::writeNumber(unsigned long magnitude, bool isNegative, uint8_t decimals)
+{
+    uint8_t digits = 1;
+    for (unsigned long rest = magnitude / 10; rest != 0; rest /= 10) {
+        ++digits;
+    }
+
+    // at least one digit before the point
+    if (decimals > 0 && digits <= decimals) {
+        digits = decimals + 1;
+    }
+
+    size_t length = digits + (decimals > 0 ? 1 : 0) + (isNegative ? 1 : 0);
+    if (length > room()) {
+        return 0;
+    }
+
+    uint8_t *end = buffer_ + index_ + length;
+    for (uint8_t i = 0; i < digits; ++i) {
+        if (i == decimals && decimals > 0) {
+            *--end = '.';
+        }
+        *--end = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+    if (isNegative) {
+        *--end = '-';
+    }
+
+    index_ += length;
     totalLength_ = index_;
+    return length;
+}
 
+void WirePacker::end()
+{
+    isPacketOpen_ = false;
+
+    uint8_t payloadLength = totalLength_ - 2;
+    uint8_t crcLength = wireCrcLength(crcWidth_);
+    totalLength_ = wirePacketLength(payloadLength, isFecEnabled_, crcWidth_);
+    buffer_[0] |= crcWidth_;
     buffer_[1] = totalLength_;
 
-    // ignore start, length, crc and end bytes
-    uint8_t payloadLength = totalLength_ - 4;
+    // include length in CRC
+    uint32_t crc = wirePacketCrc(crcWidth_, totalLength_, buffer_ + 2, payloadLength);
+    crc_ = crc;
+
+    // crc is before the end byte, least significant byte first
+    uint8_t *crcBytes = buffer_ + totalLength_ - 1 - (isFecEnabled_ ? 2 : 1) * crcLength;
+
+    if (isFecEnabled_) {
+        // expand from the last byte, so no byte is overwritten before read
+        for (int i = payloadLength - 1; i >= 0; --i) {
+            WireFec::encode(buffer_[2 + i], buffer_ + 2 + 2 * i);
+        }
+        for (uint8_t i = 0; i < crcLength; ++i) {
+            WireFec::encode(uint8_t(crc >> (8 * i)), crcBytes + 2 * i);
+        }
+    }
+    else {
+        for (uint8_t i = 0; i < crcLength; ++i) {
+            crcBytes[i] = uint8_t(crc >> (8 * i));
+        }
+    }
+
+    buffer_[totalLength_ - 1] = frameEnd_;
 
-    WireCrc crc8;
-    crc8.calc(&totalLength_, 1);   // include length in CRC
-    uint8_t crc = crc8.update(buffer_ + 2, payloadLength);
-    buffer_[index_-2] = crc;
+    if (framing_ == FRAMING_COBS) {
+        encodeCobs();
+    }
 
     // prepare for reading
     index_ = 0;
 }
 
+void WirePacker::encodeCobs()
+{
+    // move start..crc one byte ahead, so the encoded packet
+    // (one byte longer) can be written over it from index 0
+    uint8_t length = totalLength_ - 1;
+    memmove(buffer_ + 1, buffer_, length);
+
+    uint8_t codeIndex = 0;
+    uint8_t code = 1;
+    uint8_t out = 1;
+
+    // each byte is read right before its position is written
+    for (uint8_t in = 1; in <= length; ++in) {
+        uint8_t data = buffer_[in];
+
+        if (data == 0) {
+            buffer_[codeIndex] = code;
+            codeIndex = out;
+            code = 1;
+        }
+        else {
+            buffer_[out] = data;
+            ++code;
+        }
+        ++out;
+    }
+    buffer_[codeIndex] = code;
+
+    // delimiter
+    buffer_[out] = 0;
+    totalLength_ = out + 1;
+}
+
 size_t WirePacker::available()
 {
     if (isPacketOpen_) {
@@ -88,9 +263,21 @@ int WirePacker::read()
     return value;
 }
 
-void WirePacker::reset()
+size_t WirePacker::read(uint8_t *data, size_t quantity)
+{
+    if (quantity > available()) {
+        quantity = available();
+    }
+
+    memcpy(data, buffer_ + index_, quantity);
+    index_ += quantity;
+
+    return quantity;
+}
+
+void WirePacker::reset(WireFrameType type)
 {
-    buffer_[0] = frameStart_;
+    buffer_[0] = type;
     index_ = 2;
     totalLength_ = 2;
     isPacketOpen_ = true;
@@ -8,14 +8,19 @@
  * another I2C device, be it master->slave or slave->master.
  * 
  * After creating the packer object, add data with write()
- * or with Print methods such as printf(). When finished,
- * call end() to close the packet.
+ * or with Print methods such as print() (Arduino only).
+ * When finished, call end() to close the packet.
+ * 
+ * Numbers can also be written as text with writeDecimal(),
+ * writeFixed(), writeFloat() and printf(). They render straight
+ * into the packet buffer, without the per-byte calls of Print
+ * and without touching the heap.
  * 
  * After that, use available() and read() methods to
  * read each packet byte and send to the other device.
  * 
  * Packet format:
- *      [0]: start byte (0x02)
+ *      [0]: start byte, packet type (0x02 for data, see WireFrame.h)
  *      [1]: packet length
  *      [2]: data[0]
  *      [3]: data[1]
@@ -24,18 +29,38 @@
  *      [n+2]: CRC8 of packet length and data
  *      [n+3]: end byte (0x04)
  * 
+ * With a wider CRC (setCrc()), the CRC takes 2 or 4 bytes before
+ * the end byte, and its width is flagged in the start byte.
+ * 
+ * With FEC enabled (setFec()), every data byte and CRC byte is
+ * replaced by two WireFec codewords.
+ * 
+ * With FRAMING_COBS, bytes 0 to n+2 are COBS encoded and
+ * the end byte is replaced by a 0x00 delimiter (see WireFrame.h).
+ * 
  */
 #ifndef WirePacker_h
 #define WirePacker_h
 
+#ifdef ARDUINO
 #include <Arduino.h>
 #include <Print.h>
+#else
+#include <stddef.h>
+#include <string.h>
+#endif
+#include <stdarg.h>
+#include "WireFrame.h"
 
 #define PACKER_BUFFER_LENGTH 128
 
 // #define PACKER_DEBUG
 
+#ifdef ARDUINO
 class WirePacker : public Print
+#else
+class WirePacker
+#endif
 {
 public:
     WirePacker();
@@ -79,6 +104,73 @@ public:
         return write((uint8_t)n);
     }
 
+    /**
+     * Adds a number as decimal text, such as "-42". Nothing is
+     * added if the whole number doesn't fit.
+     * 
+     * @param value     number to add
+     * @return size_t   number of bytes added
+     */
+    size_t writeDecimal(long value);
+    size_t writeDecimal(unsigned long value);
+
+    inline size_t writeDecimal(int value)
+    {
+        return writeDecimal((long) value);
+    }
+    inline size_t writeDecimal(unsigned int value)
+    {
+        return writeDecimal((unsigned long) value);
+    }
+
+    /**
+     * Adds a fixed-point number as decimal text: writeFixed(-1234, 2)
+     * adds "-12.34". Nothing is added if the whole number doesn't fit.
+     * 
+     * @param value     number in units of 10^-decimals
+     * @param decimals  digits after the decimal point
+     * @return size_t   number of bytes added
+     */
+    size_t writeFixed(long value, uint8_t decimals);
+
+    /**
+     * Adds a floating point number as decimal text, rounded like
+     * Print::print(double, digits), "nan", "inf" or "ovf" (beyond
+     * 32 bits). Uses fewer decimals if the scaled value wouldn't
+     * fit 32 bits. Nothing is added if the whole number doesn't fit.
+     * 
+     * @param value     number to add
+     * @param decimals  digits after the decimal point
+     * @return size_t   number of bytes added
+     */
+    size_t writeFloat(double value, uint8_t decimals = 2);
+
+    /**
+     * Adds formatted text, cut at the end of the packet. Formats
+     * straight into the packet buffer with vsnprintf(), which
+     * doesn't allocate for integers and strings; prefer
+     * writeFloat() for floats, as %f may use the heap.
+     * 
+     * @param format    printf() format string
+     * @return size_t   number of bytes added
+     */
+    size_t printf(const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+    size_t vprintf(const char *format, va_list args);
+
+    /**
+     * Returns how many payload bytes still fit in the packet,
+     * 0 after end() is called.
+     * 
+     * @return size_t 
+     */
+    size_t room() const
+    {
+        if (!isPacketOpen_) {
+            return 0;
+        }
+        return (PACKER_BUFFER_LENGTH - packetLength()) / (isFecEnabled_ ? 2 : 1);
+    }
+
     /**
      * Returns packet length so far
      * 
@@ -87,11 +179,100 @@ public:
     size_t packetLength() const
     {
         if (isPacketOpen_) {
-            return totalLength_ + 2;
+            return wireFrameLength(wirePacketLength(totalLength_ - 2, isFecEnabled_, crcWidth_), framing_);
         }
         return totalLength_;
     }
 
+    /**
+     * Returns the CRC of the packet closed by end(), as written
+     * in it. The slave echoes it to acknowledge a FRAME_WRITE.
+     */
+    uint32_t crc() const
+    {
+        return crc_;
+    }
+
+    /**
+     * Changes the packet type set by reset(). Has no effect
+     * after end() was called.
+     * 
+     * @param type  packet type, written as start byte
+     */
+    void setFrameType(WireFrameType type)
+    {
+        if (isPacketOpen_) {
+            buffer_[0] = type;
+        }
+    }
+
+    /**
+     * Selects how the packet is framed (see WireFrame.h). Must be
+     * called before adding data, the receiver must use the same.
+     * 
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        framing_ = framing;
+    }
+
+    WireFraming framing() const
+    {
+        return framing_;
+    }
+
+    /**
+     * Enables forward error correction (see WireFec.h): payload and
+     * CRC are sent as Hamming codewords, so the receiver can correct
+     * a flipped bit per nibble instead of dropping the packet. Doubles
+     * the payload size, the receiver must also enable it. Must be
+     * called before adding data.
+     * 
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        isFecEnabled_ = enabled;
+    }
+
+    bool isFecEnabled() const
+    {
+        return isFecEnabled_;
+    }
+
+    /**
+     * Selects the CRC width (see WireFrame.h). Each extra CRC byte
+     * takes one payload byte. The receiver detects the width by
+     * itself. Must be called before adding data.
+     * 
+     * @param width     CRC_8 (default), CRC_16 or CRC_32
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        crcWidth_ = width;
+    }
+
+    WireCrcWidth crcWidth() const
+    {
+        return crcWidth_;
+    }
+
+    /**
+     * Returns the payload added so far. Valid only while the
+     * packet is open, before end() is called.
+     * 
+     */
+    const uint8_t *payload() const
+    {
+        return buffer_ + 2;
+    }
+
+    size_t payloadLength() const
+    {
+        return isPacketOpen_ ? totalLength_ - 2 : 0;
+    }
+
     /**
      * Closes the packet. After that, use avaiable() and read()
      * to get the packet bytes.
@@ -114,11 +295,21 @@ public:
      */
     int read();
 
+    /**
+     * Read up to quantity packet bytes at once.
+     * 
+     * @param data      destination array
+     * @param quantity  max number of bytes to read
+     * @return size_t   number of bytes read
+     */
+    size_t read(uint8_t *data, size_t quantity);
+
     /**
      * Resets the packing process.
      * 
+     * @param type  packet type, written as start byte
      */
-    void reset();
+    void reset(WireFrameType type = FRAME_DATA);
 
     /**
      * Debug. Prints packet data to Serial.
@@ -129,13 +320,33 @@ public:
     #endif
 
 private:
-    const uint8_t frameStart_ = 0x02;
     const uint8_t frameEnd_ = 0x04;
 
     uint8_t buffer_[PACKER_BUFFER_LENGTH];
     uint8_t index_;
     uint8_t totalLength_;
     bool isPacketOpen_;
+    WireFraming framing_;
+    bool isFecEnabled_;
+    WireCrcWidth crcWidth_;
+    uint32_t crc_;
+
+    /**
+     * COBS-encodes the closed packet in place, replacing the
+     * end byte with the 0x00 delimiter.
+     */
+    void encodeCobs();
+
+    /**
+     * Adds a fixed-point number as text, digits written from the
+     * last one back, only if all of it fits.
+     * 
+     * @param magnitude     absolute value, in units of 10^-decimals
+     * @param isNegative    true to add a minus sign
+     * @param decimals      digits after the decimal point
+     * @return size_t       number of bytes added
+     */
+    size_t writeNumber(unsigned long magnitude, bool isNegative, uint8_t decimals);
 };
 
 #endif
@@ -0,0 +1,66 @@
+/**
+ * @file WirePacketPool.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Fixed pool of unpacker blocks shared by master side requests
+ * @date 2026-10-18
+ *
+ */
+#include "WirePacketPool.h"
+
+WirePacketPool::WirePacketPool(WireUnpacker *blocks, uint8_t count)
+    :blocks_(blocks)
+    ,count_(count > WIREPOOL_MAX_BLOCKS ? WIREPOOL_MAX_BLOCKS : count)
+    ,usedMap_(0)
+    ,inUse_(0)
+    ,highWaterMark_(0)
+    ,failedCount_(0)
+{
+}
+
+WirePacketPool &WirePacketPool::shared()
+{
+    // built on the first call, and left out of sketches that never make one
+    static WireUnpacker blocks[WIREPOOL_SHARED_BLOCKS];
+    static WirePacketPool pool(blocks, WIREPOOL_SHARED_BLOCKS);
+    return pool;
+}
+
+uint8_t WirePacketPool::acquire()
+{
+    for (uint8_t i = 0; i < count_; ++i) {
+        uint32_t bit = uint32_t(1) << i;
+        if (usedMap_ & bit) {
+            continue;
+        }
+
+        usedMap_ |= bit;
+        ++inUse_;
+        if (inUse_ > highWaterMark_) {
+            highWaterMark_ = inUse_;
+        }
+
+        blocks_[i].reset();
+        return i;
+    }
+
+    ++failedCount_;
+    return WIREPOOL_NO_HANDLE;
+}
+
+void WirePacketPool::release(uint8_t handle)
+{
+    if (get(handle) == nullptr) {
+        return;
+    }
+
+    usedMap_ &= ~(uint32_t(1) << handle);
+    --inUse_;
+}
+
+WireUnpacker *WirePacketPool::get(uint8_t handle) const
+{
+    if (handle >= count_ || !(usedMap_ & (uint32_t(1) << handle))) {
+        return nullptr;
+    }
+    return blocks_ + handle;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file WirePacketPool.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Fixed pool of unpacker blocks shared by master side requests
+ * @date 2026-10-18
+ *
+ * WireSlaveRequest objects hold no packet buffer of their own: each
+ * request() borrows a WireUnpacker block from a pool, unpacks the
+ * response into it and reads the payload in place. The block goes
+ * back to the pool once the payload is read to the end, or when the
+ * next request() starts, release() is called or the object is
+ * destroyed. With WireSlaveRequest::setResponseBuffer(), the payload
+ * is copied out and the block given back as soon as the request
+ * ends, so the pool only needs as many blocks as requests in flight
+ * at a time, however many responses are held.
+ *
+ * Blocks are referred to by a handle, their index in the pool. A
+ * handle can be taken from WireSlaveRequest::takeHandle(), leaving
+ * the payload in the block (no copy) until the caller releases it.
+ *
+ * By default every WireSlaveRequest uses shared(), a pool of
+ * WIREPOOL_SHARED_BLOCKS blocks created on first use. Another pool
+ * can be given with WireSlaveRequest::setPool():
+ *
+ *      WireUnpacker blocks[8];
+ *      WirePacketPool pool(blocks, 8);
+ *      slaveReq.setPool(&pool);
+ *
+ * highWaterMark() tells how many blocks were ever in use at once,
+ * and failedCount() how many requests found the pool empty, so the
+ * pool can be sized to what the application actually needs.
+ *
+ * Not meant to be used from more than one thread or task at a time.
+ *
+ */
+#ifndef WirePacketPool_h
+#define WirePacketPool_h
+
+#include <stdint.h>
+#include "WireUnpacker.h"
+
+// handle returned when there is no free block
+#define WIREPOOL_NO_HANDLE 0xFF
+
+// blocks are tracked in a 32-bit map
+#define WIREPOOL_MAX_BLOCKS 32
+
+#ifndef WIREPOOL_SHARED_BLOCKS
+#define WIREPOOL_SHARED_BLOCKS 4
+#endif
+
+class WirePacketPool
+{
+public:
+    /**
+     * Construct a new WirePacketPool object
+     *
+     * @param blocks    unpacker blocks, must stay valid
+     * @param count     number of blocks, up to WIREPOOL_MAX_BLOCKS
+     */
+    WirePacketPool(WireUnpacker *blocks, uint8_t count);
+
+    /**
+     * Pool used by WireSlaveRequest objects without setPool().
+     */
+    static WirePacketPool &shared();
+
+    /**
+     * Takes a free block, reset for a new packet.
+     *
+     * @return uint8_t  block handle, WIREPOOL_NO_HANDLE if none is free
+     */
+    uint8_t acquire();
+
+    /**
+     * Gives a block back to the pool. Invalid handles are ignored.
+     *
+     * @param handle    handle from acquire()
+     */
+    void release(uint8_t handle);
+
+    /**
+     * Returns the block of a handle in use, or nullptr.
+     *
+     * @param handle    handle from acquire()
+     */
+    WireUnpacker *get(uint8_t handle) const;
+
+    uint8_t blockCount() const
+    {
+        return count_;
+    }
+
+    /**
+     * Number of blocks in use.
+     */
+    uint8_t inUse() const
+    {
+        return inUse_;
+    }
+
+    /**
+     * Largest number of blocks in use at once.
+     */
+    uint8_t highWaterMark() const
+    {
+        return highWaterMark_;
+    }
+
+    /**
+     * Number of acquire() calls that found no free block.
+     */
+    uint32_t failedCount() const
+    {
+        return failedCount_;
+    }
+
+    /**
+     * Restarts highWaterMark() from the blocks in use now, and
+     * failedCount() from zero.
+     */
+    void resetStats()
+    {
+        highWaterMark_ = inUse_;
+        failedCount_ = 0;
+    }
+
+private:
+    WireUnpacker *blocks_;
+    uint8_t count_;
+    uint32_t usedMap_;
+    uint8_t inUse_;
+    uint8_t highWaterMark_;
+    uint32_t failedCount_;
+
+    WirePacketPool(const WirePacketPool&);
+    WirePacketPool &operator=(const WirePacketPool&);
+};
+
+#endif
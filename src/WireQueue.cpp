@@ -0,0 +1,114 @@
+/**
+ * @file WireQueue.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Message queue of one priority class of a slave
+ * @date 2026-10-18
+ *
+ */
+#include "WireQueue.h"
+
+WireQueue::WireQueue(uint8_t *buffer, size_t size)
+    :buffer_(buffer)
+    ,size_(size)
+    ,head_(0)
+    ,used_(0)
+    ,count_(0)
+    ,budget_(0)
+    ,sentCount_(0)
+    ,totalLatency_(0)
+    ,maxLatency_(0)
+    ,overBudgetCount_(0)
+    ,droppedCount_(0)
+{
+}
+
+bool WireQueue::push(uint32_t time, const uint8_t *data, size_t length)
+{
+    if (length > UINT8_MAX || size_ - used_ < WIREQUEUE_RECORD_HEADER + length) {
+        ++droppedCount_;
+        return false;
+    }
+
+    put(uint8_t(length));
+    for (uint8_t i = 0; i < 4; ++i) {
+        put(uint8_t(time >> (8 * i)));
+    }
+    for (size_t i = 0; i < length; ++i) {
+        put(data[i]);
+    }
+
+    ++count_;
+    return true;
+}
+
+size_t WireQueue::peek(uint8_t *data, size_t length, uint32_t &time) const
+{
+    if (used_ == 0) {
+        return 0;
+    }
+
+    time = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        time |= uint32_t(at(1 + i)) << (8 * i);
+    }
+
+    size_t count = at(0) < length ? at(0) : length;
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = at(WIREQUEUE_RECORD_HEADER + i);
+    }
+    return count;
+}
+
+void WireQueue::drop()
+{
+    if (used_ == 0) {
+        return;
+    }
+
+    size_t recordLength = WIREQUEUE_RECORD_HEADER + at(0);
+    head_ = (head_ + recordLength) % size_;
+    used_ -= recordLength;
+    --count_;
+}
+
+size_t WireQueue::pop(uint8_t *data, size_t length, uint32_t &time)
+{
+    size_t count = peek(data, length, time);
+    drop();
+    return count;
+}
+
+void WireQueue::clear()
+{
+    head_ = 0;
+    used_ = 0;
+    count_ = 0;
+}
+
+void WireQueue::addLatency(uint32_t latency)
+{
+    ++sentCount_;
+    totalLatency_ += latency;
+
+    if (latency > maxLatency_) {
+        maxLatency_ = latency;
+    }
+    if (budget_ > 0 && latency > budget_) {
+        ++overBudgetCount_;
+    }
+}
+
+void WireQueue::resetStats()
+{
+    sentCount_ = 0;
+    totalLatency_ = 0;
+    maxLatency_ = 0;
+    overBudgetCount_ = 0;
+    droppedCount_ = 0;
+}
+
+void WireQueue::put(uint8_t data)
+{
+    buffer_[(head_ + used_) % size_] = data;
+    ++used_;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file WireQueue.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Message queue of one priority class of a slave
+ * @date 2026-10-18
+ *
+ * Holds the messages queued with TwoWireSlave::queue() for one
+ * priority class (see TwoWireSlave::setQueue()), oldest first, in a
+ * ring buffer given by the user. A full queue refuses new messages
+ * instead of dropping queued ones.
+ *
+ * Each queue also keeps the latency of its class: the time from
+ * queue() until the message is staged for the master to read it.
+ * With setBudget(), messages staged later than the budget are
+ * counted by overBudgetCount().
+ *
+ * Record format: [0]: data length n, [1..4]: queue time in
+ * microseconds, [5..n+4]: data
+ *
+ * Not meant to be used from more than one thread or task at a
+ * time: push from the task that runs TwoWireSlave::update().
+ *
+ */
+#ifndef WireQueue_h
+#define WireQueue_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// length and time bytes before the data of each record
+#define WIREQUEUE_RECORD_HEADER 5
+
+class WireQueue
+{
+public:
+    /**
+     * Construct a new WireQueue object
+     *
+     * @param buffer    memory for the messages, must stay valid
+     * @param size      buffer size in bytes
+     */
+    WireQueue(uint8_t *buffer, size_t size);
+
+    /**
+     * Adds a message at the end of the queue.
+     *
+     * @param time      queue time in microseconds
+     * @param data      message bytes
+     * @param length    number of bytes, up to 255
+     * @return true     queued, false if there is no room
+     */
+    bool push(uint32_t time, const uint8_t *data, size_t length);
+
+    /**
+     * Copies the oldest message, leaving it in the queue.
+     *
+     * @param data      destination array
+     * @param length    array length; longer messages are cut
+     * @param time      set to the queue time of the message
+     * @return size_t   number of bytes copied to data
+     */
+    size_t peek(uint8_t *data, size_t length, uint32_t &time) const;
+
+    /**
+     * Removes the oldest message.
+     */
+    void drop();
+
+    /**
+     * Copies and removes the oldest message, as peek() and drop().
+     */
+    size_t pop(uint8_t *data, size_t length, uint32_t &time);
+
+    bool isEmpty() const
+    {
+        return used_ == 0;
+    }
+
+    /**
+     * Number of queued messages.
+     */
+    size_t count() const
+    {
+        return count_;
+    }
+
+    void clear();
+
+    /**
+     * Adds a latency to the statistics, called by the slave when
+     * a message is staged.
+     *
+     * @param latency   microseconds
+     */
+    void addLatency(uint32_t latency);
+
+    /**
+     * Latency budget of this class in microseconds, 0 for none.
+     */
+    void setBudget(uint32_t budget)
+    {
+        budget_ = budget;
+    }
+
+    /**
+     * Number of messages staged, and their latency.
+     */
+    uint32_t sentCount() const
+    {
+        return sentCount_;
+    }
+
+    uint32_t maxLatency() const
+    {
+        return maxLatency_;
+    }
+
+    uint32_t averageLatency() const
+    {
+        return sentCount_ ? uint32_t(totalLatency_ / sentCount_) : 0;
+    }
+
+    /**
+     * Number of messages staged later than the budget.
+     */
+    uint32_t overBudgetCount() const
+    {
+        return overBudgetCount_;
+    }
+
+    /**
+     * Number of messages refused because the queue was full.
+     */
+    uint32_t droppedCount() const
+    {
+        return droppedCount_;
+    }
+
+    void resetStats();
+
+private:
+    uint8_t *buffer_;
+    size_t size_;
+    size_t head_;
+    size_t used_;
+    size_t count_;
+
+    uint32_t budget_;
+    uint32_t sentCount_;
+    uint64_t totalLatency_;
+    uint32_t maxLatency_;
+    uint32_t overBudgetCount_;
+    uint32_t droppedCount_;
+
+    uint8_t at(size_t index) const
+    {
+        return buffer_[(head_ + index) % size_];
+    }
+
+    void put(uint8_t data);
+};
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file WireScanner.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Tracks which I2C slaves are present on a bus
+ * @date 2026-10-18
+ *
+ */
+#include "WireScanner.h"
+
+#ifdef ARDUINO
+WireScanner::WireScanner(TwoWire &wire, uint8_t first, uint8_t last)
+    :wire_(wire)
+    ,transport_(wire_)
+    ,first_(first > 0 ? first : 1)
+    ,last_(last < SCANNER_ADDRESS_COUNT ? last : SCANNER_ADDRESS_COUNT - 1)
+    ,deadProbeInterval_(1000)
+    ,aliveProbeInterval_(5000)
+    ,alive_()
+    ,lastSeen_()
+    ,sweepAddress_(0)
+    ,lastSweep_(0)
+    ,millis_(0)
+    ,lastMicros_(0)
+{
+}
+#endif
+
+WireScanner::WireScanner(WireTransport &transport, uint8_t first, uint8_t last)
+    :transport_(transport)
+    ,first_(first > 0 ? first : 1)
+    ,last_(last < SCANNER_ADDRESS_COUNT ? last : SCANNER_ADDRESS_COUNT - 1)
+    ,deadProbeInterval_(1000)
+    ,aliveProbeInterval_(5000)
+    ,alive_()
+    ,lastSeen_()
+    ,sweepAddress_(0)
+    ,lastSweep_(0)
+    ,millis_(0)
+    ,lastMicros_(0)
+{
+}
+
+uint8_t WireScanner::scan()
+{
+    for (uint8_t address = first_; address <= last_; ++address) {
+        probe(address);
+    }
+
+    lastSweep_ = now();
+    return aliveCount();
+}
+
+void WireScanner::update()
+{
+    unsigned long time = now();
+
+    // a slave that went away without a failed request is only
+    // noticed by probing it
+    if (aliveProbeInterval_ > 0) {
+        for (uint8_t address = nextAlive(0); address != 0; address = nextAlive(address)) {
+            if (address >= first_ && address <= last_
+                    && time - lastSeen_[address] >= aliveProbeInterval_) {
+                probe(address);
+                return;
+            }
+        }
+    }
+
+    if (sweepAddress_ == 0) {
+        if (time - lastSweep_ < deadProbeInterval_) {
+            return;
+        }
+        sweepAddress_ = first_;
+        lastSweep_ = time;
+    }
+
+    // skip alive slaves
+    while (sweepAddress_ <= last_ && isAlive(sweepAddress_)) {
+        ++sweepAddress_;
+    }
+
+    if (sweepAddress_ <= last_) {
+        probe(sweepAddress_);
+        ++sweepAddress_;
+    }
+
+    if (sweepAddress_ > last_) {
+        sweepAddress_ = 0;
+    }
+}
+
+bool WireScanner::probe(uint8_t address)
+{
+    // address only, no data
+    bool found = transport_.write(address, nullptr, 0);
+
+    if (found) {
+        markSeen(address);
+    }
+    else {
+        markMissing(address);
+    }
+    return found;
+}
+
+void WireScanner::markSeen(uint8_t address)
+{
+    if (address >= SCANNER_ADDRESS_COUNT) {
+        return;
+    }
+
+    alive_[address / 32] |= 1UL << (address % 32);
+    lastSeen_[address] = now();
+}
+
+void WireScanner::markMissing(uint8_t address)
+{
+    if (address >= SCANNER_ADDRESS_COUNT) {
+        return;
+    }
+
+    alive_[address / 32] &= ~(1UL << (address % 32));
+}
+
+uint8_t WireScanner::nextAlive(uint8_t address) const
+{
+    for (++address; address < SCANNER_ADDRESS_COUNT; ++address) {
+        if (isAlive(address)) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+uint8_t WireScanner::aliveCount() const
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < SCANNER_ADDRESS_COUNT / 32; ++i) {
+        count += __builtin_popcount(alive_[i]);
+    }
+    return count;
+}
+
+unsigned long WireScanner::now()
+{
+    // micros() wraps every 71 minutes, so only its steps are added
+    uint32_t micros = transport_.micros();
+    uint32_t elapsed = micros - lastMicros_;
+    millis_ += elapsed / 1000;
+    lastMicros_ = micros - elapsed % 1000;
+    return millis_;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file WireScanner.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Tracks which I2C slaves are present on a bus
+ * @date 2026-10-18
+ * 
+ * WireScanner probes addresses with address-only transactions
+ * (beginTransmission() followed by endTransmission(), no data),
+ * which cost a few bytes of bus time instead of a whole
+ * WireSlaveRequest::request(). It keeps a live/dead bitmap and
+ * the last time each slave was seen.
+ * 
+ * Call scan() once to find every slave, then update() inside
+ * loop(): it probes one slave per call, sweeping the missing ones
+ * once every setDeadProbeInterval() milliseconds, and checking an
+ * alive one when it wasn't seen for setAliveProbeInterval()
+ * milliseconds. Report the outcome of regular requests with
+ * markSeen() and markMissing(), so busy slaves are seldom probed.
+ * 
+ * Use isAlive() or nextAlive() to poll only present slaves.
+ * 
+ * Besides TwoWire, any WireTransport can be used (see
+ * WireTransport.h); times are then counted from its micros().
+ * 
+ */
+#ifndef WireScanner_h
+#define WireScanner_h
+
+#include <stdint.h>
+#include "WireTransport.h"
+
+#define SCANNER_ADDRESS_COUNT 128
+
+class WireScanner
+{
+public:
+    /**
+     * Construct a new WireScanner object
+     * 
+     * @param wire      TwoWire object (Wire or Wire1)
+     * @param first     first address to probe
+     * @param last      last address to probe
+     */
+#ifdef ARDUINO
+    WireScanner(TwoWire &wire, uint8_t first = 0x08, uint8_t last = 0x77);
+#endif
+
+    /**
+     * Construct a new WireScanner object
+     * 
+     * @param transport bus access, see WireTransport.h
+     * @param first     first address to probe
+     * @param last      last address to probe
+     */
+    WireScanner(WireTransport &transport, uint8_t first = 0x08, uint8_t last = 0x77);
+
+    /**
+     * Delay in milliseconds between sweeps over missing slaves
+     */
+    void setDeadProbeInterval(unsigned long interval)
+    {
+        deadProbeInterval_ = interval;
+    }
+
+    /**
+     * Milliseconds an alive slave may go unseen before update()
+     * probes it again, 5000 by default. 0 never probes alive slaves.
+     */
+    void setAliveProbeInterval(unsigned long interval)
+    {
+        aliveProbeInterval_ = interval;
+    }
+
+    /**
+     * Probes every address in the range.
+     * 
+     * @return uint8_t  number of slaves found
+     */
+    uint8_t scan();
+
+    /**
+     * Probes an alive slave not seen for too long, or else the
+     * next missing slave, if a sweep is due.
+     * 
+     */
+    void update();
+
+    /**
+     * Probes a single address and updates its state.
+     * 
+     * @param address   slave address
+     * @return true     the slave acknowledged its address
+     */
+    bool probe(uint8_t address);
+
+    /**
+     * Records that a slave answered (e.g. a successful request).
+     * 
+     * @param address   slave address
+     */
+    void markSeen(uint8_t address);
+
+    /**
+     * Records that a slave didn't answer (e.g. SLAVE_NOT_FOUND).
+     * 
+     * @param address   slave address
+     */
+    void markMissing(uint8_t address);
+
+    bool isAlive(uint8_t address) const
+    {
+        return address < SCANNER_ADDRESS_COUNT
+                && (alive_[address / 32] & (1UL << (address % 32)));
+    }
+
+    /**
+     * Returns the time in milliseconds when the slave was last seen,
+     * 0 if never. On Arduino, with TwoWire, that's millis().
+     * 
+     * @param address   slave address
+     */
+    unsigned long lastSeen(uint8_t address) const
+    {
+        return address < SCANNER_ADDRESS_COUNT ? lastSeen_[address] : 0;
+    }
+
+    /**
+     * Returns the first alive address after the given one,
+     * or 0 if there's none. Use nextAlive(0) to start.
+     * 
+     * @param address   previous address
+     */
+    uint8_t nextAlive(uint8_t address) const;
+
+    /**
+     * Returns how many slaves are alive.
+     * 
+     */
+    uint8_t aliveCount() const;
+
+private:
+    // milliseconds from transport micros(), wraparounds included
+    unsigned long now();
+
+#ifdef ARDUINO
+    TwoWireTransport wire_;
+#endif
+    WireTransport &transport_;
+    uint8_t first_;
+    uint8_t last_;
+    unsigned long deadProbeInterval_;
+    unsigned long aliveProbeInterval_;
+
+    uint32_t alive_[SCANNER_ADDRESS_COUNT / 32];
+    unsigned long lastSeen_[SCANNER_ADDRESS_COUNT];
+
+    // next address of the current sweep, 0 if no sweep running
+    uint8_t sweepAddress_;
+    unsigned long lastSweep_;
+
+    unsigned long millis_;
+    uint32_t lastMicros_;
+};
+
+#endif
@@ -8,14 +8,42 @@
 #ifdef ARDUINO_ARCH_ESP32
 #include <Arduino.h>
 #include <driver/i2c.h>
+#include <soc/soc_caps.h>
+#if SOC_I2C_SLAVE_SUPPORT_BROADCAST
+#include <hal/i2c_ll.h>
+#endif
+#ifndef CONFIG_FREERTOS_UNICORE
+#include <esp_ipc.h>
+#endif
 
 #include "WireSlave.h"
 
+struct DriverInstall
+{
+    i2c_port_t portNum;
+    const TwoWireSlaveConfig *config;
+    esp_err_t result;
+};
+
+// the driver interrupt is allocated on the core that installs it
+static void installDriver(void *arg)
+{
+    DriverInstall *install = (DriverInstall *) arg;
+
+    install->result = i2c_driver_install(
+            install->portNum,
+            I2C_MODE_SLAVE,
+            install->config->rxBufferLength,
+            install->config->txBufferLength,
+            install->config->intrAllocFlags);
+}
+
 TwoWireSlave::TwoWireSlave(uint8_t bus_num)
     :num(bus_num & 1)
     ,portNum(i2c_port_t(bus_num & 1))
     ,sda(-1)
     ,scl(-1)
+    ,readTimeout_(1)
     ,rxIndex(0)
     ,rxLength(0)
     ,rxQueued(0)
@@ -23,6 +51,33 @@ TwoWireSlave::TwoWireSlave(uint8_t bus_num)
     ,txLength(0)
     ,txAddress(0)
     ,txQueued(0)
+    ,user_onStream(nullptr)
+    ,user_onChunk(nullptr)
+    ,endpoints_()
+    ,hasEndpoints_(false)
+    ,endpoint_(0)
+    ,isBroadcast_(false)
+    ,delta_(nullptr)
+    ,capture_(nullptr)
+    ,streamData_(nullptr)
+    ,streamLength_(0)
+    ,isStreaming_(false)
+    ,isStreamClosing_(false)
+    ,isStreamClosed_(false)
+    ,chunkOffset_(0)
+    ,rxTime_(0)
+    ,syncOffset_(0)
+    ,syncTime_(0)
+    ,syncDrift_(0)
+    ,syncCount_(0)
+    ,isTimestamping_(false)
+    ,dataReadyPin_(-1)
+    ,isDataReadyActiveLow_(true)
+    ,isNotifying_(false)
+    ,isRequestNotified_(false)
+    ,queues_()
+    ,pendingQueue_(nullptr)
+    ,isPendingStaged_(false)
     ,packer_()
     ,unpacker_()
 {
@@ -38,14 +93,19 @@ TwoWireSlave::~TwoWireSlave()
 
 bool TwoWireSlave::begin(int sda, int scl, int address)
 {
-    i2c_config_t config;
+    return begin(sda, scl, address, TwoWireSlaveConfig());
+}
+
+bool TwoWireSlave::begin(int sda, int scl, int address, const TwoWireSlaveConfig &slaveConfig)
+{
+    i2c_config_t config = {};
     config.sda_io_num = gpio_num_t(sda);
-    config.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    config.sda_pullup_en = slaveConfig.sdaPullup ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
     config.scl_io_num = gpio_num_t(scl);
-    config.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    config.scl_pullup_en = slaveConfig.sclPullup ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
     config.mode = I2C_MODE_SLAVE;
-    config.slave.addr_10bit_en = 0;
-    config.slave.slave_addr = address & 0x7F;
+    config.slave.addr_10bit_en = slaveConfig.addr10bit ? 1 : 0;
+    config.slave.slave_addr = address & (slaveConfig.addr10bit ? 0x3FF : 0x7F);
 
     esp_err_t res = i2c_param_config(portNum, &config);
 
@@ -54,49 +114,133 @@ bool TwoWireSlave::begin(int sda, int scl, int address)
         return false;
     }
 
-    res = i2c_driver_install(
-            portNum,
-            config.mode,
-            2 * I2C_BUFFER_LENGTH,  // rx buffer length
-            2 * I2C_BUFFER_LENGTH,  // tx buffer length
-            0);
+    DriverInstall install = { portNum, &slaveConfig, ESP_FAIL };
+
+    if (slaveConfig.core < 0 || slaveConfig.core == xPortGetCoreID()) {
+        installDriver(&install);
+    }
+#ifndef CONFIG_FREERTOS_UNICORE
+    else if (esp_ipc_call_blocking(slaveConfig.core, installDriver, &install) != ESP_OK) {
+        log_e("invalid core %d", slaveConfig.core);
+        return false;
+    }
+#else
+    else {
+        log_e("invalid core %d", slaveConfig.core);
+        return false;
+    }
+#endif
+    res = install.result;
 
     if (res != ESP_OK) {
         log_e("failed to install I2C driver");
     }
+
+    if (res == ESP_OK && slaveConfig.generalCall) {
+#if SOC_I2C_SLAVE_SUPPORT_BROADCAST
+        i2c_ll_slave_broadcast_enable(I2C_LL_GET_HW(portNum), true);
+#else
+        // not worth failing the whole slave for, packets sent to its
+        // own address still get through
+        log_w("general call not supported on this chip, left off");
+#endif
+    }
+
+    readTimeout_ = slaveConfig.readTimeout;
     return res == ESP_OK;
 }
 
 void TwoWireSlave::update()
 {
     uint8_t inputBuffer[I2C_BUFFER_LENGTH] = {0};
-    int16_t inputLen = 0;
+    int inputLen = readDriver(inputBuffer, I2C_BUFFER_LENGTH);
 
-    inputLen = i2c_slave_read_buffer(portNum, inputBuffer, I2C_BUFFER_LENGTH, 1);
+    if (inputLen > 0) {
+        rxTime_ = micros();
+        processInput(inputBuffer, size_t(inputLen));
+    }
 
-    if (inputLen <= 0) {
-        // nothing received or error
-        return;
+    if (isStreaming_) {
+        updateStream();
     }
+}
+
+void TwoWireSlave::processInput(const uint8_t *data, size_t length)
+{
+    // a single read may hold several packets
+    for (size_t i = 0; i < length; ++i) {
+        if (!unpacker_.isPacketOpen()) {
+            // start unpacking
+            unpacker_.reset();
+        }
 
-    if (!unpacker_.isPacketOpen()) {
-        // start unpacking
-        unpacker_.reset();
+        unpacker_.write(data[i]);
+
+        if (!unpacker_.isPacketOpen() && unpacker_.totalLength() > 0) {
+            processPacket();
+        }
     }
+}
+
+void TwoWireSlave::processPacket()
+{
+    bool needsAck = unpacker_.frameType() == FRAME_WRITE;
 
-    unpacker_.write(inputBuffer, size_t(inputLen));
+    if (unpacker_.hasError()) {
+        if (needsAck) {
+            sendAcknowledge(FRAME_NAK);
+        }
+        return;
+    }
 
-    if (unpacker_.isPacketOpen() || unpacker_.totalLength() == 0) {
-        // still waiting bytes,
-        // or received bytes that are not inside a packet
+    if (unpacker_.frameType() == FRAME_CHUNK) {
+        processChunk();
         return;
     }
 
-    if (unpacker_.hasError()) {
+    if (unpacker_.frameType() == FRAME_SYNC) {
+        processSync();
         return;
     }
 
-    if (unpacker_.available()) {
+    // an empty data packet is a request without endpoint, an empty
+    // request packet a retried one
+    bool isRequest = unpacker_.frameType() == FRAME_REQUEST
+            || (unpacker_.frameType() == FRAME_DATA && !unpacker_.available());
+    bool isRepeat = unpacker_.frameType() == FRAME_REQUEST && !unpacker_.available();
+    const Endpoint *endpoint = nullptr;
+    endpoint_ = 0;
+    isBroadcast_ = unpacker_.frameType() == FRAME_BROADCAST;
+
+    if (hasEndpoints_ && unpacker_.available()) {
+        endpoint_ = unpacker_.read();
+
+        if (endpoint_ >= WIRESLAVE_ENDPOINTS) {
+            if (needsAck) {
+                sendAcknowledge(FRAME_NAK);
+            }
+            return;
+        }
+        endpoint = &endpoints_[endpoint_];
+    }
+
+    if (isRequest) {
+        // the master came for what it was notified of; if it has to
+        // ask again, the line goes back up until a request gets through
+        if (!isRepeat) {
+            isRequestNotified_ = isNotifying_;
+        }
+        setDataReady(isRepeat && isRequestNotified_);
+    }
+
+    if (isRequest && !endpoint && !isRepeat && isPendingStaged_) {
+        // asking for more, so the staged message was read
+        pendingQueue_->drop();
+        pendingQueue_ = nullptr;
+        isPendingStaged_ = false;
+    }
+
+    if (!isRequest) {
         rxIndex = 0;
         rxLength = unpacker_.available();
 
@@ -108,25 +252,418 @@ void TwoWireSlave::update()
         rxIndex = 0;
 
         // call user callback
-        if (user_onReceive) {
-            user_onReceive(rxLength);
+        void (*onReceive)(int) = endpoint ? endpoint->onReceive : user_onReceive;
+        if (onReceive) {
+            onReceive(rxLength);
+        }
+
+        if (needsAck) {
+            sendAcknowledge(onReceive ? FRAME_ACK : FRAME_NAK);
+        }
+    }
+    else if (endpoint) {
+        if (endpoint->onRequest) {
+            sendResponse(endpoint->onRequest);
         }
     }
+    else if (user_onStream || streamData_) {
+        // start streaming, dropping whatever is pending
+        resetDriverTx();
+        txQueued = 0;
+        isPendingStaged_ = false;
+        isStreaming_ = true;
+        isStreamClosing_ = false;
+        isStreamClosed_ = false;
+        updateStream();
+    }
+    else if (hasQueued()) {
+        sendQueued();
+    }
     else if (user_onRequest) {
-        txIndex = 0;
-        txLength = 0;
-        packer_.reset();
-        user_onRequest();
-        packer_.end();
+        if (delta_) {
+            // request argument is the snapshot held by the master
+            sendDeltaResponse(unpacker_.available() ? unpacker_.read() : 0);
+        }
+        else {
+            sendResponse(user_onRequest);
+        }
+    }
+}
+
+void TwoWireSlave::processChunk()
+{
+    if (unpacker_.available() < 4) {
+        return;
+    }
+
+    uint32_t offset = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        offset |= uint32_t(unpacker_.read()) << (8 * i);
+    }
+
+    if (!unpacker_.available()) {
+        // acknowledge everything received so far
+        packer_.reset(FRAME_ACK);
+        for (uint8_t i = 0; i < 4; ++i) {
+            packer_.write(uint8_t(chunkOffset_ >> (8 * i)));
+        }
+        queueResponse();
+        return;
+    }
+
+    if (offset != chunkOffset_ || !user_onChunk) {
+        // duplicate, or a previous chunk was lost
+        return;
+    }
+
+    // straight from the unpacker buffer
+    size_t length = unpacker_.available();
+    if (user_onChunk(offset, unpacker_.payload(), length)) {
+        chunkOffset_ += length;
+    }
+}
+
+void TwoWireSlave::processSync()
+{
+    uint32_t times[4];
+    size_t count = unpacker_.available() / 4;
+    if (count != 1 && count != 4) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        times[i] = 0;
+        for (uint8_t j = 0; j < 4; ++j) {
+            times[i] |= uint32_t(unpacker_.read()) << (8 * j);
+        }
+    }
+
+    if (count == 1) {
+        // echo master transmit time, add ours
+        times[1] = rxTime_;
+        packer_.reset(FRAME_SYNC);
+        for (size_t i = 0; i < 2; ++i) {
+            for (uint8_t j = 0; j < 4; ++j) {
+                packer_.write(uint8_t(times[i] >> (8 * j)));
+            }
+        }
+        times[2] = micros();
+        for (uint8_t j = 0; j < 4; ++j) {
+            packer_.write(uint8_t(times[2] >> (8 * j)));
+        }
+        queueResponse();
+        return;
+    }
+
+    // offset = ((t2 - t1) + (t3 - t4)) / 2, keeping clock wraps
+    uint32_t forward = times[1] - times[0];
+    uint32_t backward = times[2] - times[3];
+    uint32_t offset = forward + int32_t(backward - forward) / 2;
+
+    if (syncCount_ > 0) {
+        uint32_t elapsed = times[1] - syncTime_;
+        if (elapsed > 0) {
+            float drift = float(int32_t(offset - syncOffset_)) * 1e6f / float(elapsed);
+
+            // smooth the jitter of single exchanges
+            syncDrift_ = syncCount_ > 1 ? syncDrift_ + (drift - syncDrift_) / 4 : drift;
+        }
+    }
+
+    syncOffset_ = offset;
+    syncTime_ = times[1];
+    ++syncCount_;
+}
+
+uint32_t TwoWireSlave::toMasterTime(uint32_t slaveTime) const
+{
+    if (syncCount_ == 0) {
+        return slaveTime;
+    }
+
+    float elapsed = float(int32_t(slaveTime - syncTime_));
+    return slaveTime - syncOffset_ - int32_t(syncDrift_ * elapsed / 1e6f);
+}
+
+uint32_t TwoWireSlave::masterTime() const
+{
+    return toMasterTime(micros());
+}
+
+void TwoWireSlave::sendResponse(void (*onRequest)(void), WireFrameType type)
+{
+    packer_.reset(type);
+    if (onRequest) {
+        writeTimestamp(micros());
+        onRequest();
+    }
+    queueResponse();
+}
+
+void TwoWireSlave::sendAcknowledge(WireFrameType type)
+{
+    packer_.reset(type);
+
+    // echo the CRC, unknown if the packet was corrupt
+    if (!unpacker_.hasError()) {
+        for (uint8_t i = 0; i < wireCrcLength(unpacker_.crcWidth()); ++i) {
+            packer_.write(uint8_t(unpacker_.crc() >> (8 * i)));
+        }
+    }
+    queueResponse();
+}
+
+void TwoWireSlave::sendDeltaResponse(uint8_t ackId)
+{
+    packer_.reset();
+
+    // a full snapshot takes two bytes more than the response, and
+    // room() is below DELTA_SNAPSHOT_LENGTH + 2 with COBS, FEC or
+    // wider CRCs
+    size_t maxLength = packer_.room() - 2;
+    writeTimestamp(micros());
+    user_onRequest();
+
+    uint8_t encoded[DELTA_SNAPSHOT_LENGTH + 2];
+    size_t length;
+    if (packer_.payloadLength() > maxLength) {
+        // a cut snapshot would decode fine on the master
+        log_e("delta response over %u bytes", (unsigned) maxLength);
+        encoded[0] = DELTA_NONE;
+        length = 1;
+    }
+    else {
+        length = delta_->encode(ackId, packer_.payload(), packer_.payloadLength(), encoded);
+    }
+
+    packer_.reset();
+    packer_.write(encoded, length);
+    queueResponse();
+}
+
+void TwoWireSlave::sendQueued()
+{
+    if (pendingQueue_ && pendingQueue_->isEmpty()) {
+        // cleared meanwhile
+        pendingQueue_ = nullptr;
+    }
+
+    // a message the master didn't get goes first
+    WireQueue *classQueue = pendingQueue_;
+    for (uint8_t i = 0; classQueue == nullptr && i < WIRESLAVE_PRIORITIES; ++i) {
+        if (queues_[i] && !queues_[i]->isEmpty()) {
+            classQueue = queues_[i];
+        }
+    }
+    if (classQueue == nullptr) {
+        return;
+    }
+
+    // kept in the queue until the next request shows it was read
+    uint8_t data[PACKER_BUFFER_LENGTH];
+    uint32_t time;
+    size_t length = classQueue->peek(data, sizeof(data), time);
+
+    packer_.reset();
+    writeTimestamp(time);
+    packer_.write(data, length);
+    queueResponse();
+
+    if (classQueue != pendingQueue_) {
+        classQueue->addLatency(micros() - time);
+        pendingQueue_ = classQueue;
+    }
+    isPendingStaged_ = true;
+
+    size_t count = 0;
+    for (uint8_t i = 0; i < WIRESLAVE_PRIORITIES; ++i) {
+        count += queues_[i] ? queues_[i]->count() : 0;
+    }
+    if (count > 1) {
+        // more to read
+        setDataReady(true);
+    }
+}
+
+size_t TwoWireSlave::queuedRoom() const
+{
+    // room() of an empty packet, without resetting packer_
+    bool isFec = packer_.isFecEnabled();
+    size_t empty = wireFrameLength(
+            wirePacketLength(0, isFec, packer_.crcWidth()), packer_.framing());
+    size_t room = (PACKER_BUFFER_LENGTH - empty) / (isFec ? 2 : 1);
+
+    return room - (isTimestamping_ ? 4 : 0);
+}
+
+void TwoWireSlave::writeTimestamp(uint32_t slaveTime)
+{
+    if (isTimestamping_) {
+        uint32_t time = toMasterTime(slaveTime);
+        for (uint8_t i = 0; i < 4; ++i) {
+            packer_.write(uint8_t(time >> (8 * i)));
+        }
+    }
+}
+
+void TwoWireSlave::queueResponse()
+{
+    txIndex = 0;
+    txLength = 0;
+
+    // replaces a staged message, which is then sent again
+    isPendingStaged_ = false;
+    packer_.end();
+
+    while (packer_.available()) {
+        txBuffer[txIndex] = packer_.read();
+        ++txIndex;
+    }
+    txLength = txIndex;
+
+    resetDriverTx();
+    writeDriver(txBuffer, txLength);
+}
+
+void TwoWireSlave::updateStream()
+{
+    while (isStreaming_) {
+        if (txQueued == 0) {
+            // stage the next chunk
+            packer_.reset();
+
+            if (isStreamClosing_) {
+                // empty packet closes the stream, once the driver takes it
+                isStreamClosed_ = true;
+            }
+            else if (user_onStream) {
+                isStreamClosing_ = !user_onStream();
+            }
+            else {
+                size_t written = write(streamData_, streamLength_);
+                streamData_ += written;
+                streamLength_ -= written;
+                isStreamClosing_ = streamLength_ == 0;
+            }
+
+            packer_.end();
+
+            while (packer_.available()) {
+                txBuffer[txQueued] = packer_.read();
+                ++txQueued;
+            }
+        }
+
+        // the driver accepts the whole chunk or nothing
+        if (writeDriver(txBuffer, txQueued) != int(txQueued)) {
+            return;
+        }
+
+        txQueued = 0;
+
+        if (isStreamClosed_) {
+            isStreaming_ = false;
+        }
+    }
+
+    streamData_ = nullptr;
+}
+
+int TwoWireSlave::readDriver(uint8_t *data, size_t length)
+{
+    int count = i2c_slave_read_buffer(portNum, data, length, readTimeout_);
+    if (capture_ && count > 0) {
+        capture_->record(WireCapture::READ, micros(), data, count);
+    }
+    return count;
+}
+
+int TwoWireSlave::writeDriver(const uint8_t *data, size_t length)
+{
+    int count = i2c_slave_write_buffer(portNum, data, length, 0);
+    if (capture_ && count > 0) {
+        capture_->record(WireCapture::WRITE, micros(), data, count);
+    }
+    return count;
+}
+
+void TwoWireSlave::resetDriverTx()
+{
+    i2c_reset_tx_fifo(portNum);
+    if (capture_) {
+        capture_->record(WireCapture::RESET_TX, micros());
+    }
+}
 
-        while (packer_.available()) {
-            txBuffer[txIndex] = packer_.read();
-            ++txIndex;
+void TwoWireSlave::setDataReadyPin(int pin, bool activeLow)
+{
+    if (dataReadyPin_ >= 0) {
+        pinMode(dataReadyPin_, INPUT);
+    }
+
+    dataReadyPin_ = pin;
+    isDataReadyActiveLow_ = activeLow;
+
+    if (pin >= 0) {
+        pinMode(pin, activeLow ? OUTPUT_OPEN_DRAIN : OUTPUT);
+        setDataReady(isNotifying_);
+    }
+}
+
+void TwoWireSlave::notify()
+{
+    setDataReady(true);
+}
+
+void TwoWireSlave::setQueue(uint8_t priority, WireQueue *queue)
+{
+    if (priority < WIRESLAVE_PRIORITIES) {
+        if (queues_[priority] == pendingQueue_) {
+            pendingQueue_ = nullptr;
+            isPendingStaged_ = false;
+        }
+        queues_[priority] = queue;
+    }
+}
+
+bool TwoWireSlave::queue(uint8_t priority, const uint8_t *data, size_t length)
+{
+    WireQueue *classQueue = getQueue(priority);
+
+    // refused now rather than cut when sent
+    if (classQueue == nullptr || length > queuedRoom()
+            || !classQueue->push(micros(), data, length)) {
+        return false;
+    }
+
+    notify();
+    return true;
+}
+
+bool TwoWireSlave::hasQueued() const
+{
+    for (uint8_t i = 0; i < WIRESLAVE_PRIORITIES; ++i) {
+        if (queues_[i] && !queues_[i]->isEmpty()) {
+            return true;
         }
-        txLength = txIndex;
+    }
+    return false;
+}
+
+void TwoWireSlave::setDataReady(bool isAsserted)
+{
+    isNotifying_ = isAsserted;
+
+    if (dataReadyPin_ >= 0) {
+        digitalWrite(dataReadyPin_, isAsserted != isDataReadyActiveLow_ ? HIGH : LOW);
+    }
+}
 
-        i2c_reset_tx_fifo(portNum);
-        i2c_slave_write_buffer(portNum, txBuffer, txLength, 0);
+void TwoWireSlave::captureConfig()
+{
+    if (capture_) {
+        const uint8_t config[] = { packer_.framing(), packer_.isFecEnabled() };
+        capture_->record(WireCapture::CONFIG, micros(), config, sizeof(config));
     }
 }
 
@@ -141,12 +678,21 @@ size_t TwoWireSlave::write(uint8_t data)
 
 size_t TwoWireSlave::write(const uint8_t *data, size_t quantity)
 {
-    for (size_t i = 0; i < quantity; ++i) {
-        if (!write(data[i])) {
-            return i;
-        }
+    if (packer_.packetLength() >= I2C_BUFFER_LENGTH) {
+        return 0;
     }
-    return quantity;
+
+    // the packer buffer is as long as txBuffer, so it bounds the rest
+    return packer_.write(data, quantity);
+}
+
+size_t TwoWireSlave::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t count = packer_.vprintf(format, args);
+    va_end(args);
+    return count;
 }
 
 int TwoWireSlave::available(void)
@@ -182,7 +728,7 @@ void TwoWireSlave::flush(void)
     rxQueued = 0;
     txQueued = 0;
     i2c_reset_rx_fifo(portNum);
-    i2c_reset_tx_fifo(portNum);
+    resetDriverTx();
 }
 
 void TwoWireSlave::onReceive(void (*function)(int))
@@ -195,6 +741,38 @@ void TwoWireSlave::onRequest(void (*function)(void))
     user_onRequest = function;
 }
 
+void TwoWireSlave::onReceive(uint8_t endpoint, void (*function)(int))
+{
+    if (endpoint < WIRESLAVE_ENDPOINTS) {
+        endpoints_[endpoint].onReceive = function;
+        hasEndpoints_ = true;
+    }
+}
+
+void TwoWireSlave::onRequest(uint8_t endpoint, void (*function)(void))
+{
+    if (endpoint < WIRESLAVE_ENDPOINTS) {
+        endpoints_[endpoint].onRequest = function;
+        hasEndpoints_ = true;
+    }
+}
+
+void TwoWireSlave::onStream(bool (*function)(void))
+{
+    user_onStream = function;
+}
+
+void TwoWireSlave::stream(const uint8_t *data, size_t length)
+{
+    streamData_ = length ? data : nullptr;
+    streamLength_ = length;
+}
+
+void TwoWireSlave::onChunk(bool (*sink)(uint32_t, const uint8_t*, size_t))
+{
+    user_onChunk = sink;
+}
+
 TwoWireSlave WireSlave = TwoWireSlave(0);
 TwoWireSlave WireSlave1 = TwoWireSlave(1);
 
@@ -29,9 +29,54 @@
 #include <Stream.h>
 #include <WirePacker.h>
 #include <WireUnpacker.h>
+#include <WireDelta.h>
+#include <WireCapture.h>
+#include <WireQueue.h>
 
 #define I2C_BUFFER_LENGTH 128
 
+// number of virtual endpoints, see onReceive(endpoint, ...)
+#ifndef WIRESLAVE_ENDPOINTS
+#define WIRESLAVE_ENDPOINTS 8
+#endif
+
+// number of priority classes, see setQueue()
+#ifndef WIRESLAVE_PRIORITIES
+#define WIRESLAVE_PRIORITIES 3
+#endif
+
+/**
+ * Driver settings used by TwoWireSlave::begin(). The defaults
+ * are the ones used by begin(sda, scl, address).
+ */
+struct TwoWireSlaveConfig
+{
+    bool sdaPullup = true;
+    bool sclPullup = true;
+
+    // use 10-bit address instead of 7-bit
+    bool addr10bit = false;
+
+    // driver ring buffer sizes, bytes buffered between update() calls
+    size_t rxBufferLength = 2 * I2C_BUFFER_LENGTH;
+    size_t txBufferLength = 2 * I2C_BUFFER_LENGTH;
+
+    // ticks update() waits for incoming bytes, 0 doesn't block
+    TickType_t readTimeout = 1;
+
+    // ESP_INTR_FLAG_* flags for the driver interrupt
+    int intrAllocFlags = 0;
+
+    // core that services the driver interrupt, -1 for the calling core
+    int core = -1;
+
+    // also accept packets sent to the general call address (0), on
+    // chips whose I2C slave supports it (SOC_I2C_SLAVE_SUPPORT_BROADCAST
+    // set in soc/soc_caps.h); elsewhere begin() logs a warning and
+    // leaves it off
+    bool generalCall = false;
+};
+
 class TwoWireSlave : public Stream
 {
 public:
@@ -39,8 +84,21 @@ public:
     ~TwoWireSlave();
 
     bool begin(int sda, int scl, int address);
+    bool begin(int sda, int scl, int address, const TwoWireSlaveConfig &config);
     void update();
 
+    /**
+     * Handles bytes read from the driver, as update() does: collects
+     * them with the unpacker and, when a packet is complete, calls
+     * the user callbacks and queues the response. Keeps no driver
+     * state, so the protocol can be driven without a master, to
+     * measure packet handling for instance.
+     *
+     * @param data      bytes read from the driver
+     * @param length    number of bytes
+     */
+    void processInput(const uint8_t *data, size_t length);
+
     size_t write(uint8_t);
     size_t write(const uint8_t *, size_t);
     int available(void);
@@ -68,15 +126,354 @@ public:
     {
         return write((uint8_t)n);
     }
+
+    /**
+     * Returns how many payload bytes still fit in the response,
+     * inside onRequest().
+     */
+    size_t room() const
+    {
+        return packer_.room();
+    }
+
+    /**
+     * Add numbers to the response as text, rendered straight into
+     * the packet without Print's per-byte calls or the heap (see
+     * WirePacker::writeDecimal(), writeFixed() and writeFloat()).
+     */
+    inline size_t writeDecimal(long value)
+    {
+        return packer_.writeDecimal(value);
+    }
+    inline size_t writeDecimal(unsigned long value)
+    {
+        return packer_.writeDecimal(value);
+    }
+    inline size_t writeDecimal(int value)
+    {
+        return packer_.writeDecimal(value);
+    }
+    inline size_t writeDecimal(unsigned int value)
+    {
+        return packer_.writeDecimal(value);
+    }
+    inline size_t writeFixed(long value, uint8_t decimals)
+    {
+        return packer_.writeFixed(value, decimals);
+    }
+    inline size_t writeFloat(double value, uint8_t decimals = 2)
+    {
+        return packer_.writeFloat(value, decimals);
+    }
+
+    /**
+     * Formats into the response packet, see WirePacker::printf().
+     * Unlike Print::printf(), longer texts don't use the heap.
+     */
+    size_t printf(const char *format, ...) __attribute__ ((format (printf, 2, 3)));
     
     void onReceive(void (*)(int));
     void onRequest(void (*)());
 
+    /**
+     * Selects the packet framing (see WireFrame.h) for both
+     * directions, which must match the one used by the master.
+     * 
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        packer_.setFraming(framing);
+        unpacker_.setFraming(framing);
+        captureConfig();
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec())
+     * for both directions, which must match the master.
+     * 
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        packer_.setFec(enabled);
+        unpacker_.setFec(enabled);
+        captureConfig();
+    }
+
+    /**
+     * Selects the CRC width of the packets sent to the master (see
+     * WireFrame.h), which must match the one the master expects.
+     * Packets from the master are checked with whatever width
+     * they were sent with.
+     * 
+     * @param width     CRC_8 (default), CRC_16 or CRC_32
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        packer_.setCrc(width);
+    }
+
+    /**
+     * Records every driver read and write in a WireCapture ring
+     * buffer, to be saved with WireCapture::writeTo() and replayed
+     * offline (see WireCapture.h).
+     * 
+     * @param capture   ring buffer, or nullptr to stop recording
+     */
+    void setCapture(WireCapture *capture)
+    {
+        capture_ = capture;
+        captureConfig();
+    }
+
+    /**
+     * Enables delta encoding of onRequest() responses (see
+     * WireDelta.h): only the bytes that changed since the response
+     * the master last confirmed are sent. The master must use a
+     * WireDeltaDecoder (WireSlaveRequest::setDelta()). Responses are
+     * limited to the packet payload minus 2 bytes: DELTA_SNAPSHOT_LENGTH
+     * with STX framing and CRC8, less with COBS, FEC or wider CRCs.
+     * Longer ones are not sent, DELTA_NONE is, so request() fails
+     * on the master with PACKET_ERROR.
+     * Not available together with endpoints, and streams are not
+     * delta encoded.
+     * 
+     * @param encoder   encoder holding the snapshots, or nullptr to disable
+     */
+    void setDelta(WireDeltaEncoder *encoder)
+    {
+        delta_ = encoder;
+    }
+
+    /**
+     * Registers callbacks for a virtual endpoint, so several logical
+     * devices can share one slave address. Once any endpoint is
+     * registered, the first payload byte of every packet is taken as
+     * the endpoint ID and the packet goes to that endpoint's callbacks;
+     * packets for unregistered endpoints are dropped. Masters address
+     * endpoints with WireSlaveRequest::setEndpoint(). An empty packet
+     * still calls onRequest()/onStream().
+     *
+     * Responses are not cached per endpoint: the endpoint's
+     * onRequest() builds each one when it's requested, in the same
+     * TX buffer as every other response, since the driver holds only
+     * one at a time anyway.
+     *
+     * The first payload byte is also where delta requests carry
+     * their snapshot ID (setDelta()) and messages their ID
+     * (WireMessage.h), so neither can be used with endpoints.
+     * 
+     * @param endpoint  endpoint ID, less than WIRESLAVE_ENDPOINTS
+     */
+    void onReceive(uint8_t endpoint, void (*)(int));
+    void onRequest(uint8_t endpoint, void (*)());
+
+    /**
+     * Returns the endpoint of the packet being handled, or 0 if
+     * no endpoint is registered.
+     */
+    uint8_t endpoint() const
+    {
+        return endpoint_;
+    }
+
+    /**
+     * Returns true while handling a packet broadcast to all slaves
+     * (see WireSlaveWrite::broadcast()), false for packets sent to
+     * this slave address. Valid inside the onReceive() callback.
+     */
+    bool isBroadcast() const
+    {
+        return isBroadcast_;
+    }
+
+    /**
+     * Registers a stream producer, used instead of onRequest().
+     *
+     * When the master sends an empty packet, the producer is called
+     * each time there is room in the driver TX buffer for another
+     * packet. It adds the next chunk with write() (up to
+     * I2C_BUFFER_LENGTH - 4 bytes) and returns true while more chunks
+     * follow, so every chunk but the last must have at least one byte.
+     * An empty packet is sent after the last chunk. Read the
+     * stream on the master with WireSlaveRequest::beginStream() and
+     * readStream().
+     *
+     * Only the chunk being staged is kept in RAM, so the stream
+     * can be longer than any buffer.
+     */
+    void onStream(bool (*)(void));
+
+    /**
+     * Streams a buffer as consecutive packets on the next empty
+     * packet received, without a producer callback. The buffer
+     * is not copied, so it must stay valid until streamed.
+     *
+     * @param data      bytes to be streamed
+     * @param length    number of bytes
+     */
+    void stream(const uint8_t *data, size_t length);
+
+    /**
+     * Receives bulk transfers sent with WireBulkWrite. The sink is
+     * called with every chunk in order, so it can be written straight
+     * to flash without keeping the whole transfer in RAM; it returns
+     * false to refuse a chunk, which the master then sends again.
+     * Chunks ahead of the expected offset are dropped and resent by
+     * the master, and chunks already received are ignored.
+     *
+     * The driver RX buffer (TwoWireSlaveConfig::rxBufferLength) must
+     * hold the window of chunks the master sends at once.
+     *
+     * @param sink  called as sink(offset, data, length)
+     */
+    void onChunk(bool (*sink)(uint32_t, const uint8_t*, size_t));
+
+    /**
+     * Sets the offset of the next expected chunk: 0 to start a new
+     * transfer, or the number of bytes already stored to resume one.
+     * The master starts sending from this offset.
+     */
+    void setChunkOffset(uint32_t offset)
+    {
+        chunkOffset_ = offset;
+    }
+
+    uint32_t chunkOffset() const
+    {
+        return chunkOffset_;
+    }
+
+    /**
+     * Converts a micros() value of this slave to the master clock,
+     * kept by WireTimeSync exchanges: offset from the last exchange,
+     * corrected by the drift measured between exchanges. Returns the
+     * value unchanged until the first exchange.
+     *
+     * Exchanges are handled by update(), so the more often it's
+     * called, the better the estimate.
+     */
+    uint32_t toMasterTime(uint32_t slaveTime) const;
+
+    uint32_t masterTime() const;
+
+    bool isSynced() const
+    {
+        return syncCount_ > 0;
+    }
+
+    /**
+     * Slave clock minus master clock at the last exchange, in
+     * microseconds, and drift of the slave clock in ppm (positive
+     * when it runs faster than the master clock).
+     */
+    int32_t syncOffset() const
+    {
+        return int32_t(syncOffset_);
+    }
+
+    float syncDrift() const
+    {
+        return syncDrift_;
+    }
+
+    /**
+     * Adds the generation time, in master clock, as the first 4
+     * payload bytes of every onRequest() response, so the master can
+     * tell how old the data is (see WireSlaveRequest::setTimestamps()).
+     *
+     * @param enabled   true to add timestamps
+     */
+    void setTimestamps(bool enabled)
+    {
+        isTimestamping_ = enabled;
+    }
+
+    /**
+     * Selects a data-ready pin, wired to the master (see
+     * WireNotifier.h). notify() asserts it, and the next request
+     * from the master releases it, so the master only requests
+     * from slaves that have something new. If the master retries
+     * that request after a broken read, the line is asserted again,
+     * so a request that fails for good is made again later.
+     *
+     * Active low lines are open drain and need a pull-up, so
+     * several slaves can share one; active high lines are driven
+     * both ways.
+     *
+     * @param pin       GPIO number, -1 to disable
+     * @param activeLow true if the line is asserted low
+     */
+    void setDataReadyPin(int pin, bool activeLow = true);
+
+    /**
+     * Asserts the data-ready line, telling the master that a new
+     * response or event is waiting for its request.
+     */
+    void notify();
+
+    /**
+     * Returns true while the data-ready line is asserted.
+     */
+    bool isNotifying() const
+    {
+        return isNotifying_;
+    }
+
+    /**
+     * Gives a queue to a priority class, 0 being the most urgent.
+     * Requests without endpoint (and without a stream set) get the
+     * oldest message of the most urgent class holding any, and
+     * onRequest() only runs when every queue is empty, so an alarm
+     * doesn't wait behind routine responses. Queued messages are
+     * sent as they are, not delta encoded.
+     *
+     * A sent message stays in its queue until the next request
+     * shows the master read it: a request the master retries after
+     * a broken read (see WireSlaveRequest::request()), or a response
+     * staged in between, gets the same message again.
+     *
+     * Received packets are handed to onReceive() as update() reads
+     * them, in order, so they don't go through queues.
+     *
+     * @param priority  class, less than WIRESLAVE_PRIORITIES
+     * @param queue     queue of the class, nullptr to remove it
+     */
+    void setQueue(uint8_t priority, WireQueue *queue);
+
+    WireQueue *getQueue(uint8_t priority) const
+    {
+        return priority < WIRESLAVE_PRIORITIES ? queues_[priority] : nullptr;
+    }
+
+    /**
+     * Queues a message for the master, and asserts the data-ready
+     * line (see notify()). The line stays asserted while messages
+     * wait to be sent.
+     *
+     * Call it from the task that runs update(): queues have no lock.
+     *
+     * @param priority  class given to setQueue()
+     * @param data      payload, up to a packet payload, 4 bytes less
+     *                  with setTimestamps()
+     * @param length    number of bytes
+     * @return true     queued, false if the class has no queue or no
+     *                  room, or if the message wouldn't fit a packet
+     */
+    bool queue(uint8_t priority, const uint8_t *data, size_t length);
+
+    /**
+     * Returns true if any class has a queued message.
+     */
+    bool hasQueued() const;
+
 private:
     uint8_t num;
     i2c_port_t portNum;
     int8_t sda;
     int8_t scl;
+    TickType_t readTimeout_;
 
     uint8_t rxBuffer[I2C_BUFFER_LENGTH];
     uint16_t rxIndex;
@@ -91,9 +488,141 @@ private:
 
     void (*user_onRequest)(void);
     void (*user_onReceive)(int);
+    bool (*user_onStream)(void);
+    bool (*user_onChunk)(uint32_t, const uint8_t*, size_t);
+
+    struct Endpoint
+    {
+        void (*onReceive)(int);
+        void (*onRequest)(void);
+    };
+
+    Endpoint endpoints_[WIRESLAVE_ENDPOINTS];
+    bool hasEndpoints_;
+    uint8_t endpoint_;
+    bool isBroadcast_;
+
+    WireDeltaEncoder *delta_;
+    WireCapture *capture_;
+
+    const uint8_t *streamData_;
+    size_t streamLength_;
+    bool isStreaming_;
+    bool isStreamClosing_;
+    bool isStreamClosed_;
+
+    uint32_t chunkOffset_;
+
+    uint32_t rxTime_;
+    uint32_t syncOffset_;
+    uint32_t syncTime_;
+    float syncDrift_;
+    uint32_t syncCount_;
+    bool isTimestamping_;
+
+    int8_t dataReadyPin_;
+    bool isDataReadyActiveLow_;
+    bool isNotifying_;
+    bool isRequestNotified_;
+
+    WireQueue *queues_[WIRESLAVE_PRIORITIES];
+
+    // queue whose oldest message was sent and not yet confirmed,
+    // and whether that message is still in the driver TX buffer
+    WireQueue *pendingQueue_;
+    bool isPendingStaged_;
 
     WirePacker packer_;
     WireUnpacker unpacker_;
+
+    /**
+     * Handles the packet completed in the unpacker.
+     */
+    void processPacket();
+
+    /**
+     * Hands an in-order FRAME_CHUNK packet to onChunk(), or answers
+     * an empty one with FRAME_ACK holding the expected offset.
+     */
+    void processChunk();
+
+    /**
+     * Answers a FRAME_SYNC request with the receive and transmit
+     * times, or updates the offset and drift from a follow-up
+     * holding the four times of an exchange.
+     */
+    void processSync();
+
+    /**
+     * Packs what the callback writes and queues it in the driver
+     * TX buffer, replacing any previous response.
+     */
+    void sendResponse(void (*onRequest)(void), WireFrameType type = FRAME_DATA);
+
+    /**
+     * Answers the FRAME_WRITE packet in the unpacker with FRAME_ACK
+     * or FRAME_NAK holding its CRC, so that the master tells this
+     * answer from a stale one still in the driver TX buffer.
+     */
+    void sendAcknowledge(WireFrameType type);
+
+    /**
+     * sendResponse() for onRequest(), delta encoded against the
+     * snapshot the master holds.
+     * 
+     * @param ackId     snapshot ID sent by the master
+     */
+    void sendDeltaResponse(uint8_t ackId);
+
+    /**
+     * Sends the message the master didn't get, if any, or else the
+     * oldest message of the most urgent queue, counting its latency.
+     */
+    void sendQueued();
+
+    /**
+     * Payload room of a response packet with the packer settings,
+     * less the timestamp, if any.
+     */
+    size_t queuedRoom() const;
+
+    /**
+     * Adds the generation time to the response, if enabled with
+     * setTimestamps().
+     * 
+     * @param slaveTime     generation time in slave micros()
+     */
+    void writeTimestamp(uint32_t slaveTime);
+
+    /**
+     * Closes the packer packet and queues it in the driver TX buffer.
+     */
+    void queueResponse();
+
+    /**
+     * Stages stream packets into the driver TX buffer until it's
+     * full or the stream ends. txQueued holds the length of the
+     * packet in txBuffer still waiting for room in the driver.
+     */
+    void updateStream();
+
+    /**
+     * Driver access. Every call to the ESP-IDF slave API goes
+     * through these three methods, which also feed the capture.
+     */
+    int readDriver(uint8_t *data, size_t length);
+    int writeDriver(const uint8_t *data, size_t length);
+    void resetDriverTx();
+
+    /**
+     * Records the framing and FEC settings, if capturing.
+     */
+    void captureConfig();
+
+    /**
+     * Drives the data-ready pin, if any.
+     */
+    void setDataReady(bool isAsserted);
 };
 
 
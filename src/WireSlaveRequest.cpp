@@ -1,14 +1,77 @@
+#include <string.h>
 #include "WireSlaveRequest.h"
 
+#ifdef ARDUINO
 WireSlaveRequest::WireSlaveRequest(TwoWire &wire, uint8_t address, uint16_t responseLength)
     :wire_(wire)
+    ,transport_(wire_)
     ,address_(address)
-    ,readLength_(responseLength + 4)    // start, length, crc and end bytes
+    ,responseLength_(responseLength)
     ,retryDelay_(10)
     ,maxAttempts_(5)
     ,lastStatus_(NONE)
+    ,endpoint_(0)
+    ,hasEndpoint_(false)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,correctedCount_(0)
+    ,retryCount_(0)
+    ,delta_(nullptr)
+    ,isTimestamping_(false)
+    ,generatedAt_(0)
+    ,receivedAt_(0)
+    ,pool_(&WirePacketPool::shared())
+    ,handle_(WIREPOOL_NO_HANDLE)
+    ,rxData_(nullptr)
+    ,rxLength_(0)
+    ,rxIndex_(0)
+    ,responseBuffer_(nullptr)
+    ,responseBufferLength_(0)
+    ,isRepeatDue_(false)
+    ,attempts_(0)
+    ,isTriggerDue_(false)
+    ,pollTime_(0)
 {
 }
+#endif
+
+WireSlaveRequest::WireSlaveRequest(WireTransport &transport, uint8_t address, uint16_t responseLength)
+    :transport_(transport)
+    ,address_(address)
+    ,responseLength_(responseLength)
+    ,retryDelay_(10)
+    ,maxAttempts_(5)
+    ,lastStatus_(NONE)
+    ,endpoint_(0)
+    ,hasEndpoint_(false)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,correctedCount_(0)
+    ,retryCount_(0)
+    ,delta_(nullptr)
+    ,isTimestamping_(false)
+    ,generatedAt_(0)
+    ,receivedAt_(0)
+    ,pool_(&WirePacketPool::shared())
+    ,handle_(WIREPOOL_NO_HANDLE)
+    ,rxData_(nullptr)
+    ,rxLength_(0)
+    ,rxIndex_(0)
+    ,responseBuffer_(nullptr)
+    ,responseBufferLength_(0)
+    ,isRepeatDue_(false)
+    ,attempts_(0)
+    ,isTriggerDue_(false)
+    ,pollTime_(0)
+{
+}
+
+WireSlaveRequest::~WireSlaveRequest()
+{
+    release();
+}
 
 bool WireSlaveRequest::request(uint8_t address)
 {
@@ -16,40 +79,62 @@ bool WireSlaveRequest::request(uint8_t address)
         address_ = address;
     }
 
-    uint8_t attempts = 0;
+    WireUnpacker *block = acquireBlock();
+    if (block == nullptr) {
+        lastStatus_ = NO_BUFFER;
+        return false;
+    }
+    WireUnpacker &unpacker = *block;
 
-    WireUnpacker unpacker;
+    uint8_t attempts = 0;
 
     bool sendTrigger = true;
+    uint8_t buffer[UNPACKER_BUFFER_LENGTH + 1];
+    size_t readLength = frameReadLength();
 
     while (attempts < maxAttempts_) {
-        if (sendTrigger) {
-            triggerUpdate();
-            sendTrigger = false;
+        size_t returned;
+        uint32_t readTime;
+
+        if (sendTrigger && retryDelay_ == 0) {
+            if (attempts > 0) {
+                transport_.delay(attemptWait(attempts));
+            }
+            readTime = transport_.micros();
+            returned = triggerUpdate(buffer, readLength);
         }
+        else {
+            if (sendTrigger) {
+                triggerUpdate();
+            }
 
-        // wait until slave fills its output buffer
-        delay(retryDelay_ * (attempts + 1));
+            // wait until slave fills its output buffer
+            transport_.delay(attemptWait(attempts));
+
+            readTime = transport_.micros();
+            returned = transport_.read(address_, buffer, readLength);
+        }
+        sendTrigger = false;
 
-        uint8_t returned = wire_.requestFrom(address_, readLength_);
         if (returned == 0) {
+            release();
             lastStatus_ = SLAVE_NOT_FOUND;
             return false;
         }
 
-        while (wire_.available()) {
-            uint8_t c = wire_.read();
-            unpacker.write(c);
-        }
+        collect(unpacker, buffer, returned);
 
         if (unpacker.available()) {
             // a complete packet was read
+            receivedAt_ = readTime;
             break;
         }
         else if (unpacker.hasError()) {
-            // retry request
+            // retry request, the slave sends the same response
+            ++retryCount_;
             unpacker.reset();
             sendTrigger = true;
+            isRepeatDue_ = true;
         }
 
         ++attempts;
@@ -63,24 +148,367 @@ bool WireSlaveRequest::request(uint8_t address)
             // not sure what could lead here
             lastStatus_ = MAX_ATTEMPTS;
         }
+        // the response wasn't read, ask for it again next time
+        isRepeatDue_ = true;
+        release();
         return false;
     }
 
-    // copy payload bytes to rxBuffer
-    rxIndex_ = 0;
-    while (unpacker.available() && (rxIndex_ < UNPACKER_BUFFER_LENGTH)) {
-        rxBuffer_[rxIndex_] = unpacker.read();
-        ++rxIndex_;
+    bool requestAgain = false;
+    if (!finishPacket(unpacker, requestAgain)) {
+        if (requestAgain) {
+            // slave doesn't have our snapshot, get a full one
+            return request();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void WireSlaveRequest::start(uint8_t address)
+{
+    if (address != 0) {
+        address_ = address;
+    }
+
+    if (acquireBlock() == nullptr) {
+        lastStatus_ = NO_BUFFER;
+        return;
+    }
+
+    lastStatus_ = BUSY;
+    attempts_ = 0;
+    isTriggerDue_ = true;
+    startAttempt();
+}
+
+bool WireSlaveRequest::poll()
+{
+    if (lastStatus_ != BUSY) {
+        return true;
+    }
+
+    if (int32_t(transport_.micros() - pollTime_) < 0) {
+        // slave still filling its output buffer
+        return false;
+    }
+
+    WireUnpacker *block = pool_->get(handle_);
+    if (block == nullptr) {
+        // released while busy
+        lastStatus_ = NO_BUFFER;
+        return true;
+    }
+    WireUnpacker &unpacker = *block;
+
+    uint8_t buffer[UNPACKER_BUFFER_LENGTH + 1];
+    uint32_t readTime = transport_.micros();
+    size_t returned = transport_.read(address_, buffer, frameReadLength());
+
+    if (returned == 0) {
+        release();
+        lastStatus_ = SLAVE_NOT_FOUND;
+        return true;
+    }
+
+    collect(unpacker, buffer, returned);
+
+    if (unpacker.available()) {
+        receivedAt_ = readTime;
+
+        bool requestAgain = false;
+        if (finishPacket(unpacker, requestAgain) || !requestAgain) {
+            return true;
+        }
+
+        // slave doesn't have our snapshot, get a full one
+        start();
+        return !isBusy();
+    }
+    else if (unpacker.hasError()) {
+        // retry request, the slave sends the same response
+        ++retryCount_;
+        unpacker.reset();
+        isTriggerDue_ = true;
+        isRepeatDue_ = true;
+    }
+
+    ++attempts_;
+
+    if (attempts_ == maxAttempts_) {
+        if (unpacker.hasError()) {
+            lastStatus_ = PACKET_ERROR;
+        }
+        else {
+            lastStatus_ = MAX_ATTEMPTS;
+        }
+        isRepeatDue_ = true;
+        release();
+        return true;
+    }
+
+    startAttempt();
+    return false;
+}
+
+void WireSlaveRequest::startAttempt()
+{
+    if (isTriggerDue_) {
+        triggerUpdate();
+        isTriggerDue_ = false;
+    }
+
+    // same waits as request()
+    pollTime_ = transport_.micros() + attemptWait(attempts_) * 1000UL;
+}
+
+void WireSlaveRequest::collect(WireUnpacker &unpacker, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        if (!unpacker.isPacketOpen() && !unpacker.hasError()
+                && unpacker.totalLength() > 0
+                && unpacker.frameType() != FRAME_DATA) {
+            // skip a leftover acknowledge packet
+            unpacker.reset();
+        }
+        unpacker.write(data[i]);
+    }
+}
+
+bool WireSlaveRequest::finishPacket(WireUnpacker &unpacker, bool &requestAgain)
+{
+    isRepeatDue_ = false;
+    attachPayload(unpacker);
+
+    if (delta_) {
+        bool hadSnapshot = delta_->ackId() != 0;
+
+        if (!applyDelta()) {
+            requestAgain = hadSnapshot;
+            lastStatus_ = PACKET_ERROR;
+            return false;
+        }
+    }
+
+    if (isTimestamping_ && !takeTimestamp()) {
+        release();
+        lastStatus_ = PACKET_ERROR;
+        return false;
+    }
+
+    if (!detachPayload()) {
+        lastStatus_ = PACKET_ERROR;
+        return false;
     }
 
-    rxLength_ = rxIndex_;
-    rxIndex_ = 0;
     lastStatus_ = PACKET_READ;
+    return true;
+}
+
+bool WireSlaveRequest::takeTimestamp()
+{
+    if (rxLength_ < 4) {
+        return false;
+    }
+
+    generatedAt_ = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        generatedAt_ |= uint32_t(rxData_[i]) << (8 * i);
+    }
 
+    rxData_ += 4;
+    rxLength_ -= 4;
     return true;
 }
 
+bool WireSlaveRequest::detachPayload()
+{
+    if (responseBuffer_ == nullptr || handle_ == WIREPOOL_NO_HANDLE) {
+        return true;
+    }
+
+    if (rxLength_ > responseBufferLength_) {
+        release();
+        return false;
+    }
+
+    uint16_t length = rxLength_;
+    memcpy(responseBuffer_, rxData_, length);
+
+    // the request is over, so is the need for the block
+    release();
+    rxData_ = responseBuffer_;
+    rxLength_ = length;
+    return true;
+}
+
+bool WireSlaveRequest::applyDelta()
+{
+    bool isDecoded = delta_->decode(rxData_, rxLength_);
+
+    // the response is the snapshot from now on
+    release();
+    if (!isDecoded) {
+        return false;
+    }
+
+    rxData_ = delta_->snapshot();
+    rxLength_ = delta_->length();
+    return true;
+}
+
+void WireSlaveRequest::beginStream(uint8_t address)
+{
+    if (address != 0) {
+        address_ = address;
+    }
+
+    lastStatus_ = NONE;
+    triggerUpdate();
+}
+
+bool WireSlaveRequest::readStream()
+{
+    if (lastStatus_ == STREAM_END) {
+        return false;
+    }
+
+    WireUnpacker *block = acquireBlock();
+    if (block == nullptr) {
+        lastStatus_ = NO_BUFFER;
+        return false;
+    }
+    WireUnpacker &unpacker = *block;
+
+    // read up to the length byte, which is the third
+    // byte when the packet is COBS encoded
+    uint8_t headerLength = wireFrameLength(2, framing_);
+    uint8_t buffer[UNPACKER_BUFFER_LENGTH + 1];
+
+    for (uint8_t attempts = 0; attempts < maxAttempts_; ++attempts) {
+        if (attempts > 0) {
+            // wait until slave stages the next packet, 1 ms at least
+            transport_.delay((retryDelay_ ? retryDelay_ : 1) * attempts);
+        }
+
+        size_t returned = transport_.read(address_, buffer, headerLength);
+        if (returned == 0) {
+            release();
+            lastStatus_ = SLAVE_NOT_FOUND;
+            return false;
+        }
+
+        unpacker.reset();
+        unpacker.write(buffer, returned);
+
+        if (unpacker.hasError()) {
+            // packet boundaries are lost
+            release();
+            lastStatus_ = PACKET_ERROR;
+            return false;
+        }
+
+        if (unpacker.totalLength() == headerLength) {
+            break;
+        }
+        // no packet staged yet
+    }
+
+    if (unpacker.totalLength() != headerLength) {
+        release();
+        lastStatus_ = MAX_ATTEMPTS;
+        return false;
+    }
+
+    // remaining bytes of this packet only
+    size_t packetLength = wireFrameLength(unpacker.expectedLength(), framing_);
+    if (packetLength > sizeof(buffer)) {
+        packetLength = sizeof(buffer);
+    }
+    size_t remaining = transport_.read(address_, buffer, packetLength - headerLength);
+    unpacker.write(buffer, remaining);
+
+    if (remaining == 0 || unpacker.isPacketOpen() || unpacker.hasError()) {
+        release();
+        lastStatus_ = PACKET_ERROR;
+        return false;
+    }
+
+    attachPayload(unpacker);
+
+    if (rxLength_ == 0) {
+        release();
+        lastStatus_ = STREAM_END;
+        return false;
+    }
+
+    if (!detachPayload()) {
+        lastStatus_ = PACKET_ERROR;
+        return false;
+    }
+
+    lastStatus_ = PACKET_READ;
+    return true;
+}
+
+WireUnpacker *WireSlaveRequest::acquireBlock()
+{
+    release();
+
+    handle_ = pool_->acquire();
+    WireUnpacker *block = pool_->get(handle_);
+    if (block) {
+        block->setFraming(framing_);
+        block->setFec(isFecEnabled_);
+    }
+    return block;
+}
+
+void WireSlaveRequest::attachPayload(WireUnpacker &unpacker)
+{
+    if (unpacker.correctedBits() > 0) {
+        ++correctedCount_;
+    }
+
+    // read in place, the block is kept until released
+    rxData_ = unpacker.payload();
+    rxLength_ = unpacker.available();
+    rxIndex_ = 0;
+}
+
+void WireSlaveRequest::release()
+{
+    pool_->release(handle_);
+    handle_ = WIREPOOL_NO_HANDLE;
+    rxData_ = nullptr;
+    rxLength_ = 0;
+    rxIndex_ = 0;
+}
+
+uint8_t WireSlaveRequest::takeHandle()
+{
+    WireUnpacker *block = pool_->get(handle_);
+    if (block == nullptr || lastStatus_ != PACKET_READ) {
+        return WIREPOOL_NO_HANDLE;
+    }
+
+    // skip what was already taken from the payload
+    while (block->payload() < rxData_ + rxIndex_) {
+        block->read();
+    }
+
+    uint8_t handle = handle_;
+    handle_ = WIREPOOL_NO_HANDLE;
+    release();
+    return handle;
+}
+
+#ifdef ARDUINO
 String WireSlaveRequest::lastStatusToString() const
+#else
+const char *WireSlaveRequest::lastStatusToString() const
+#endif
 {
     switch (lastStatus_) {
     case NONE: return "none";
@@ -88,6 +516,9 @@ String WireSlaveRequest::lastStatusToString() const
     case SLAVE_NOT_FOUND: return "slave not found";
     case PACKET_ERROR: return "packet error";
     case MAX_ATTEMPTS: return "max attempts";
+    case STREAM_END: return "stream end";
+    case NO_BUFFER: return "no buffer";
+    case BUSY: return "busy";
     default: return "unknown";
     }
 }
@@ -105,20 +536,68 @@ int WireSlaveRequest::read()
 {
     int value = -1;
     if (lastStatus_ == PACKET_READ && rxIndex_ < rxLength_) {
-        value = rxBuffer_[rxIndex_];
+        value = rxData_[rxIndex_];
         ++rxIndex_;
+
+        if (rxIndex_ == rxLength_ && handle_ != WIREPOOL_NO_HANDLE) {
+            // all read, other requests can have the block
+            release();
+        }
     }
     return value;
 }
 
-void WireSlaveRequest::triggerUpdate()
+unsigned long WireSlaveRequest::attemptWait(uint8_t attempts) const
+{
+    if (retryDelay_ == 0) {
+        // the first answer comes with the trigger (writeRead()),
+        // retries still back off, or they'd keep the bus busy
+        return attempts;
+    }
+    return retryDelay_ * (attempts + 1);
+}
+
+size_t WireSlaveRequest::frameReadLength() const
+{
+    size_t length = wireFrameLength(
+            wirePacketLength(responseLength_, isFecEnabled_, crcWidth_), framing_);
+
+    // longer frames wouldn't fit the unpacker anyway
+    if (length > UNPACKER_BUFFER_LENGTH + 1) {
+        length = UNPACKER_BUFFER_LENGTH + 1;
+    }
+    return length;
+}
+
+size_t WireSlaveRequest::triggerUpdate(uint8_t *response, size_t responseLength)
 {
     WirePacker packer;
+    packer.setFraming(framing_);
+    packer.setFec(isFecEnabled_);
+    packer.setCrc(crcWidth_);
+    if (hasEndpoint_) {
+        packer.reset(FRAME_REQUEST);
+        packer.write(endpoint_);
+    }
+    else if (delta_) {
+        // request argument is the snapshot we hold
+        packer.reset(FRAME_REQUEST);
+        packer.write(delta_->ackId());
+    }
+    else if (isRepeatDue_) {
+        // empty request: the last response arrived broken
+        packer.reset(FRAME_REQUEST);
+    }
     packer.end();
 
-    wire_.beginTransmission(address_);
-    while (packer.available()) {
-        wire_.write(packer.read());
+    // one payload byte at most, with FEC, COBS and CRC_32
+    uint8_t trigger[14];
+    size_t triggerLength = packer.read(trigger, sizeof(trigger));
+
+    if (response) {
+        return transport_.writeRead(address_, trigger, triggerLength, response, responseLength);
     }
-    wire_.endTransmission();
+
+    transport_.write(address_, trigger, triggerLength);
+    return 0;
 }
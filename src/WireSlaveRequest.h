@@ -16,14 +16,32 @@
  * Use setRetryDelay() and setAttemps() if errors are
  * happening frequently.
  * 
+ * Responses longer than a packet can be streamed by the slave
+ * and read with beginStream() and readStream().
+ * 
+ * start() and poll() make the same request without blocking
+ * during the retry delays, so requests on several buses can
+ * overlap (see WireSweep.h).
+ * 
+ * Besides TwoWire, any WireTransport can be used, such as
+ * WireLinuxTransport on Linux boards (see WireTransport.h).
+ * 
+ * The response is unpacked into a block borrowed from a
+ * WirePacketPool, so objects don't carry a packet buffer each (see
+ * WirePacketPool.h). The block goes back to the pool once the
+ * payload is read, or as soon as the request ends if a buffer was
+ * given with setResponseBuffer().
+ * 
  */
 #ifndef WireSlaveRequest_h
 #define WireSlaveRequest_h
 
 #include <stdint.h>
-#include <Wire.h>
+#include "WireTransport.h"
 #include "WirePacker.h"
 #include "WireUnpacker.h"
+#include "WireDelta.h"
+#include "WirePacketPool.h"
 
 class WireSlaveRequest
 {
@@ -35,6 +53,9 @@ public:
         SLAVE_NOT_FOUND,
         PACKET_ERROR,
         MAX_ATTEMPTS,
+        STREAM_END,
+        NO_BUFFER,
+        BUSY,
     };
 
     /**
@@ -44,10 +65,28 @@ public:
      * @param address           slave address
      * @param responseLength    max payload length
      */
+#ifdef ARDUINO
     WireSlaveRequest(TwoWire &wire, uint8_t address, uint16_t responseLength);
+#endif
+
+    /**
+     * Construct a new WireSlaveRequest object on another bus
+     * 
+     * @param transport         bus access, see WireTransport.h
+     * @param address           slave address
+     * @param responseLength    max payload length
+     */
+    WireSlaveRequest(WireTransport &transport, uint8_t address, uint16_t responseLength);
+
+    ~WireSlaveRequest();
 
     /**
-     * Delay in milliseconds between retry attempts
+     * Delay in milliseconds between retry attempts. With 0, the
+     * trigger and the first read are made in a single transaction
+     * (WireTransport::writeRead()), which suits slaves that stage
+     * their answer quickly; a missed answer is read again by the
+     * following attempts, 1 ms apart for the first retry, 2 ms for
+     * the second and so on.
      */
     void setRetryDelay(unsigned long retryDelay)
     {
@@ -64,12 +103,186 @@ public:
         maxAttempts_ = attempts;
     }
 
+    /**
+     * Requests from a virtual endpoint of the slave (see
+     * TwoWireSlave::onRequest(endpoint, ...)) instead of the default
+     * onRequest() callback.
+     * 
+     * @param endpoint  endpoint ID
+     */
+    void setEndpoint(uint8_t endpoint)
+    {
+        endpoint_ = endpoint;
+        hasEndpoint_ = true;
+    }
+
+    /**
+     * Selects the packet framing (see WireFrame.h), which must
+     * match the one used by the slave.
+     * 
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        framing_ = framing;
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec()),
+     * which must match the slave. The payload limit is halved, and
+     * packets with a few flipped bits are corrected instead of
+     * being requested again.
+     * 
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        isFecEnabled_ = enabled;
+    }
+
+    /**
+     * Selects the CRC width (see WireFrame.h) of the request packets
+     * and of the responses, which must match the slave. Each extra
+     * CRC byte makes the response one byte longer on the bus.
+     * 
+     * @param width     CRC_8 (default), CRC_16 or CRC_32
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        crcWidth_ = width;
+    }
+
+    /**
+     * Number of packets read with bits corrected by FEC, each
+     * one a retry saved.
+     */
+    uint32_t correctedCount() const
+    {
+        return correctedCount_;
+    }
+
+    /**
+     * Number of packets requested again because of errors.
+     */
+    uint32_t retryCount() const
+    {
+        return retryCount_;
+    }
+
+    /**
+     * Enables delta encoded responses (see TwoWireSlave::setDelta()).
+     * The decoder keeps a copy of the last response, and request()
+     * gets only the bytes that changed, while available() and read()
+     * still return the whole response. Not available together with
+     * setEndpoint().
+     * 
+     * @param decoder   decoder holding the snapshot, or nullptr to disable
+     */
+    void setDelta(WireDeltaDecoder *decoder)
+    {
+        delta_ = decoder;
+    }
+
+    /**
+     * Takes the generation time added by the slave to every response
+     * (see TwoWireSlave::setTimestamps()) out of the payload, so that
+     * generatedAt() and dataAge() tell how old the data is.
+     * 
+     * @param enabled   true if the slave adds timestamps
+     */
+    void setTimestamps(bool enabled)
+    {
+        isTimestamping_ = enabled;
+    }
+
+    /**
+     * Master clock (WireTransport::micros()) when the slave generated
+     * the last response, as estimated by the slave after WireTimeSync
+     * exchanges.
+     */
+    uint32_t generatedAt() const
+    {
+        return generatedAt_;
+    }
+
+    /**
+     * Master clock when the read that got the last response started.
+     * receivedAt() - generatedAt() is the one-way latency.
+     */
+    uint32_t receivedAt() const
+    {
+        return receivedAt_;
+    }
+
+    /**
+     * Age of the last response, in microseconds.
+     */
+    uint32_t dataAge()
+    {
+        return transport_.micros() - generatedAt_;
+    }
+
+    /**
+     * Selects the pool the response blocks are borrowed from,
+     * WirePacketPool::shared() by default. Releases the current
+     * response.
+     * 
+     * @param pool      packet pool
+     */
+    void setPool(WirePacketPool *pool)
+    {
+        release();
+        pool_ = pool;
+    }
+
+    /**
+     * Gives the block of the last response back to the pool. The
+     * response can't be read afterwards.
+     */
+    void release();
+
+    /**
+     * @brief Copies each response to the given buffer when the
+     * request ends, giving its block back to the pool at once, so
+     * responses can be held without holding pool blocks.
+     * 
+     * A response longer than the buffer fails with PACKET_ERROR.
+     * takeHandle() has no block to hand over afterwards.
+     * 
+     * @param buffer    response buffer, nullptr to read in place
+     * @param length    buffer length, responseLength at least
+     */
+    void setResponseBuffer(uint8_t *buffer, uint16_t length)
+    {
+        release();
+        responseBuffer_ = buffer;
+        responseBufferLength_ = buffer ? length : 0;
+    }
+
+    /**
+     * @brief Hands the block of the last response to the caller, who
+     * reads the remaining payload from it and must release it.
+     * 
+     *      uint8_t handle = slaveReq.takeHandle();
+     *      WireUnpacker *packet = pool.get(handle);
+     *      // packet->available(), packet->read(), packet->payload()
+     *      pool.release(handle);
+     * 
+     * Delta encoded responses (setDelta()), responses copied to a
+     * buffer (setResponseBuffer()) and payloads already read to the
+     * end are not kept in a block.
+     * 
+     * @return uint8_t  block handle, WIREPOOL_NO_HANDLE if there is none
+     */
+    uint8_t takeHandle();
+
     /**
      * @brief Requests data from an ESP32 I2C slave, packed with WirePacker.
      * 
      * If a packet was successfully retrieved, methods available() and
      * read() can be used to retrieve the payload. Otherwise, check
-     * lastStatus() or lastStatusString() to see what went wrong.
+     * lastStatus() or lastStatusString() to see what went wrong. The
+     * status is NO_BUFFER if the pool had no free block.
      * 
      * @param address   slave address (optional)
      * @return true     a new packet was read
@@ -77,12 +290,62 @@ public:
      */
     bool request(uint8_t address = 0);
 
+    /**
+     * @brief Starts a request like request(), without waiting: the
+     * retry delays are spent between poll() calls instead.
+     * 
+     * lastStatus() is BUSY until poll() returns true.
+     * 
+     * @param address   slave address (optional)
+     */
+    void start(uint8_t address = 0);
+
+    /**
+     * @brief Reads the slave answer of a request started by start(),
+     * once its retry delay is over, and sends the trigger again if
+     * needed. Each call blocks only during a bus transaction.
+     * 
+     * @return true     the request is over, check lastStatus()
+     * @return false    still waiting for the slave
+     */
+    bool poll();
+
+    bool isBusy() const
+    {
+        return lastStatus_ == BUSY;
+    }
+
+    /**
+     * @brief Asks the slave to start streaming (see TwoWireSlave::onStream()).
+     * Packets are then read one by one with readStream().
+     * 
+     * @param address   slave address (optional)
+     */
+    void beginStream(uint8_t address = 0);
+
+    /**
+     * @brief Reads the next packet of a stream started by beginStream().
+     * 
+     * The packet header is read first so that exactly one packet is
+     * taken from the slave, leaving the following ones in its buffer.
+     * Returns false with lastStatus() STREAM_END once the slave closes
+     * the stream.
+     * 
+     * @return true     a new packet was read
+     * @return false    stream ended or something wrong happened
+     */
+    bool readStream();
+
     Status lastStatus() const
     {
         return lastStatus_;
     }
 
+#ifdef ARDUINO
     String lastStatusToString() const;
+#else
+    const char *lastStatusToString() const;
+#endif
 
     /**
      * Returns how many payload bytes are available to be read, after
@@ -101,23 +364,120 @@ public:
     int read();
 
 private:
-    TwoWire &wire_;
+#ifdef ARDUINO
+    TwoWireTransport wire_;
+#endif
+    WireTransport &transport_;
     uint8_t address_;
-    uint8_t readLength_;
+    uint8_t responseLength_;
     unsigned long retryDelay_;
     uint8_t maxAttempts_;
     Status lastStatus_;
+    uint8_t endpoint_;
+    bool hasEndpoint_;
+    WireFraming framing_;
+    bool isFecEnabled_;
+    WireCrcWidth crcWidth_;
+    uint32_t correctedCount_;
+    uint32_t retryCount_;
+    WireDeltaDecoder *delta_;
+    bool isTimestamping_;
+    uint32_t generatedAt_;
+    uint32_t receivedAt_;
 
-    uint8_t rxBuffer_[UNPACKER_BUFFER_LENGTH];
+    WirePacketPool *pool_;
+    uint8_t handle_;
+    const uint8_t *rxData_;
     uint16_t rxLength_;
     uint16_t rxIndex_;
+    uint8_t *responseBuffer_;
+    uint16_t responseBufferLength_;
+
+    // the last response was not read, see triggerUpdate()
+    bool isRepeatDue_;
+
+    // start() and poll() state
+    uint8_t attempts_;
+    bool isTriggerDue_;
+    uint32_t pollTime_;
+
+    /**
+     * Releases the previous response and borrows a block for a
+     * new one, with the framing and FEC settings.
+     * 
+     * @return WireUnpacker*    the block, or nullptr if none is free
+     */
+    WireUnpacker *acquireBlock();
+
+    /**
+     * Adds bytes read from the slave to the unpacker, skipping
+     * leftover acknowledge packets.
+     */
+    void collect(WireUnpacker &unpacker, const uint8_t *data, size_t length);
+
+    /**
+     * Takes the complete packet in the block as the response,
+     * undoing delta encoding and timestamps.
+     * 
+     * @param requestAgain  set if the slave must send a full response
+     * @return true         response read, false with lastStatus() set
+     */
+    bool finishPacket(WireUnpacker &unpacker, bool &requestAgain);
+
+    /**
+     * Sends the trigger for a request started by start(), and
+     * schedules the next poll() read.
+     */
+    void startAttempt();
+
+    /**
+     * Points rxData_ to the payload unpacked in the block.
+     */
+    void attachPayload(WireUnpacker &unpacker);
+
+    /**
+     * Applies the delta encoded payload to the snapshot, which
+     * becomes the response, and releases the block.
+     */
+    bool applyDelta();
+
+    /**
+     * Milliseconds to wait before reading the answer of an attempt.
+     */
+    unsigned long attemptWait(uint8_t attempts) const;
+
+    /**
+     * Takes the generation time out of the payload, into generatedAt_.
+     */
+    bool takeTimestamp();
+
+    /**
+     * Copies the payload to the response buffer, if there is one,
+     * and releases the block.
+     */
+    bool detachPayload();
+
+    WireSlaveRequest(const WireSlaveRequest&);
+    WireSlaveRequest &operator=(const WireSlaveRequest&);
+
+    /**
+     * Length of the frame read from the slave, up to what the
+     * unpacker holds.
+     */
+    size_t frameReadLength() const;
 
     /**
-     * @brief Sends an empty packet to the slave in order to trigger
-     * its output buffer update.
+     * @brief Sends an empty packet, or a request packet with the
+     * endpoint, to the slave in order to trigger its output buffer update.
+     * After a broken response, the request packet is empty, so the
+     * slave sends a queued message again instead of the next one.
+     * If response is given, the answer is read in the same transaction.
      * 
+     * @param response          destination array of the answer
+     * @param responseLength    number of bytes to read
+     * @return size_t           number of bytes read
      */
-    void triggerUpdate();
+    size_t triggerUpdate(uint8_t *response = nullptr, size_t responseLength = 0);
 };
 
 #endif
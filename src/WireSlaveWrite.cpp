@@ -0,0 +1,167 @@
+#include "WireSlaveWrite.h"
+#include "WireUnpacker.h"
+
+#ifdef ARDUINO
+WireSlaveWrite::WireSlaveWrite(TwoWire &wire, uint8_t address)
+    :wire_(wire)
+    ,transport_(wire_)
+    ,address_(address)
+    ,retryDelay_(10)
+    ,maxAttempts_(5)
+    ,lastStatus_(NONE)
+{
+    packer_.reset(FRAME_WRITE);
+}
+#endif
+
+WireSlaveWrite::WireSlaveWrite(WireTransport &transport, uint8_t address)
+    :transport_(transport)
+    ,address_(address)
+    ,retryDelay_(10)
+    ,maxAttempts_(5)
+    ,lastStatus_(NONE)
+{
+    packer_.reset(FRAME_WRITE);
+}
+
+size_t WireSlaveWrite::write(uint8_t data)
+{
+    return packer_.write(data);
+}
+
+size_t WireSlaveWrite::write(const uint8_t *data, size_t quantity)
+{
+    return packer_.write(data, quantity);
+}
+
+bool WireSlaveWrite::send(uint8_t address)
+{
+    if (address != 0) {
+        address_ = address;
+    }
+
+    packer_.end();
+
+    uint8_t packet[PACKER_BUFFER_LENGTH];
+    size_t packetLength = packer_.read(packet, sizeof(packet));
+    uint32_t crc = packer_.crc();
+
+    packer_.reset(FRAME_WRITE);
+    lastStatus_ = MAX_ATTEMPTS;
+
+    for (uint8_t attempts = 0; attempts < maxAttempts_; ++attempts) {
+        if (!transport_.write(address_, packet, packetLength)) {
+            lastStatus_ = SLAVE_NOT_FOUND;
+
+            // a busy slave may take the next attempt
+            if (attempts + 1 < maxAttempts_) {
+                transport_.delay(retryDelay_ * (attempts + 1));
+            }
+            continue;
+        }
+
+        // wait until slave processes the packet
+        transport_.delay(retryDelay_ * (attempts + 1));
+
+        Status status = readAcknowledge(crc);
+        if (status == ACKNOWLEDGED) {
+            lastStatus_ = ACKNOWLEDGED;
+            return true;
+        }
+        if (status == NOT_ACKNOWLEDGED) {
+            lastStatus_ = NOT_ACKNOWLEDGED;
+        }
+    }
+
+    return false;
+}
+
+bool WireSlaveWrite::broadcast()
+{
+    // the first byte must not be taken for a general call command
+    if (packer_.framing() != FRAMING_STX) {
+        lastStatus_ = UNSUPPORTED;
+        return false;
+    }
+
+    packer_.setFrameType(FRAME_BROADCAST);
+    packer_.end();
+
+    uint8_t packet[PACKER_BUFFER_LENGTH];
+    size_t packetLength = packer_.read(packet, sizeof(packet));
+
+    packer_.reset(FRAME_WRITE);
+
+    // general call address
+    if (!transport_.write(0, packet, packetLength)) {
+        lastStatus_ = SLAVE_NOT_FOUND;
+        return false;
+    }
+
+    lastStatus_ = NONE;
+    return true;
+}
+
+WireSlaveWrite::Status WireSlaveWrite::readAcknowledge(uint32_t crc)
+{
+    // the answer holds the CRC of the packet
+    uint8_t crcLength = wireCrcLength(packer_.crcWidth());
+    uint8_t ackLength = wireFrameLength(
+            wirePacketLength(crcLength, packer_.isFecEnabled(), packer_.crcWidth()), packer_.framing());
+    uint8_t answer[PACKER_BUFFER_LENGTH];
+
+    // answers to earlier packets may still be in the slave buffer,
+    // one per failed attempt at most
+    for (uint8_t stale = 0; stale <= maxAttempts_; ++stale) {
+        size_t answerLength = transport_.read(address_, answer, ackLength);
+        if (answerLength == 0) {
+            return NONE;
+        }
+
+        WireUnpacker unpacker;
+        unpacker.setFraming(packer_.framing());
+        unpacker.setFec(packer_.isFecEnabled());
+        unpacker.write(answer, answerLength);
+
+        if (unpacker.isPacketOpen() || unpacker.hasError()) {
+            return NONE;
+        }
+
+        WireFrameType type = unpacker.frameType();
+        if (type != FRAME_ACK && type != FRAME_NAK) {
+            return NONE;
+        }
+
+        // a NAK of a corrupt packet has no CRC
+        if (type == FRAME_NAK && unpacker.available() == 0) {
+            return NOT_ACKNOWLEDGED;
+        }
+
+        uint32_t echo = 0;
+        for (uint8_t i = 0; i < unpacker.available(); ++i) {
+            echo |= uint32_t(unpacker.payload()[i]) << (8 * i);
+        }
+        if (unpacker.available() == crcLength && echo == crc) {
+            return type == FRAME_ACK ? ACKNOWLEDGED : NOT_ACKNOWLEDGED;
+        }
+    }
+
+    return NONE;
+}
+
+#ifdef ARDUINO
+String WireSlaveWrite::lastStatusToString() const
+#else
+const char *WireSlaveWrite::lastStatusToString() const
+#endif
+{
+    switch (lastStatus_) {
+    case NONE: return "none";
+    case ACKNOWLEDGED: return "acknowledged";
+    case SLAVE_NOT_FOUND: return "slave not found";
+    case NOT_ACKNOWLEDGED: return "not acknowledged";
+    case MAX_ATTEMPTS: return "max attempts";
+    case UNSUPPORTED: return "unsupported";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,238 @@
+/**
+ * @file WireSlaveWrite.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Helper class to write packed data to an ESP32 slave
+ * @date 2026-10-18
+ * 
+ * This class is the writing counterpart of WireSlaveRequest.
+ * Data is added with write() or Print methods such as print(),
+ * then send() packs it as a FRAME_WRITE packet and transmits the
+ * whole packet with a single Wire.write() call.
+ * 
+ * The slave (TwoWireSlave) answers every FRAME_WRITE packet with
+ * a FRAME_ACK packet if it was received intact and handed to
+ * onReceive(), or FRAME_NAK otherwise. The answer holds the CRC of
+ * the packet (none in a NAK of a corrupt packet), so send() skips
+ * answers to earlier packets left in the slave buffer, and
+ * transmits the packet again until it's acknowledged or the
+ * attempts run out.
+ * 
+ * Note that if an acknowledge is lost, the slave receives the
+ * packet twice, and that two identical packets in a row have the
+ * same CRC, so a stale answer to the first one acknowledges both.
+ * 
+ * broadcast() sends the packet to all slaves at once instead.
+ * 
+ * Besides TwoWire, any WireTransport can be used (see
+ * WireTransport.h). Without Arduino, Print methods are not available.
+ * 
+ */
+#ifndef WireSlaveWrite_h
+#define WireSlaveWrite_h
+
+#include <stdint.h>
+#include "WireTransport.h"
+#include "WirePacker.h"
+
+#ifdef ARDUINO
+class WireSlaveWrite : public Print
+#else
+class WireSlaveWrite
+#endif
+{
+public:
+    enum Status
+    {
+        NONE,
+        ACKNOWLEDGED,
+        SLAVE_NOT_FOUND,
+        NOT_ACKNOWLEDGED,
+        MAX_ATTEMPTS,
+        UNSUPPORTED,
+    };
+
+    /**
+     * Construct a new WireSlaveWrite object
+     * 
+     * @param wire      TwoWire object (Wire or Wire1)
+     * @param address   slave address
+     */
+#ifdef ARDUINO
+    WireSlaveWrite(TwoWire &wire, uint8_t address);
+#endif
+
+    /**
+     * Construct a new WireSlaveWrite object on another bus
+     * 
+     * @param transport bus access, see WireTransport.h
+     * @param address   slave address
+     */
+    WireSlaveWrite(WireTransport &transport, uint8_t address);
+
+    /**
+     * Delay in milliseconds between sending the packet and
+     * reading the acknowledge, and before the next attempt when
+     * the slave didn't take the packet. Grows with each attempt.
+     */
+    void setRetryDelay(unsigned long retryDelay)
+    {
+        retryDelay_ = retryDelay;
+    }
+
+    /**
+     * Number of send attempts before giving up with an error status
+     * 
+     * @param attempts 
+     */
+    void setAttempts(uint8_t attempts)
+    {
+        maxAttempts_ = attempts;
+    }
+
+    /**
+     * Selects the packet framing (see WireFrame.h), which must
+     * match the one used by the slave. Clears the packet.
+     * 
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        packer_.setFraming(framing);
+        packer_.reset(FRAME_WRITE);
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec()),
+     * which must match the slave. Clears the packet.
+     * 
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        packer_.setFec(enabled);
+        packer_.reset(FRAME_WRITE);
+    }
+
+    /**
+     * Selects the CRC width (see WireFrame.h) of the packet and of
+     * the acknowledge, which must match the slave. Clears the packet.
+     * 
+     * @param width     CRC_8 (default), CRC_16 or CRC_32
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        packer_.setCrc(width);
+        packer_.reset(FRAME_WRITE);
+    }
+
+    /**
+     * Add a byte to the packet.
+     * 
+     * @param data      byte to be added
+     * @return size_t   1 if the byte was added
+     */
+    size_t write(uint8_t data);
+
+    /**
+     * Add a number of bytes to the packet.
+     * 
+     * @param data      byte array to be added
+     * @param quantity  number of bytes to add
+     * @return size_t   number of bytes added
+     */
+    size_t write(const uint8_t *data, size_t quantity);
+
+    /**
+     * Returns how many payload bytes still fit in the packet.
+     */
+    size_t room() const
+    {
+        return packer_.room();
+    }
+
+    inline size_t write(const char * s)
+    {
+        return write((uint8_t*) s, strlen(s));
+    }
+    inline size_t write(unsigned long n)
+    {
+        return write((uint8_t)n);
+    }
+    inline size_t write(long n)
+    {
+        return write((uint8_t)n);
+    }
+    inline size_t write(unsigned int n)
+    {
+        return write((uint8_t)n);
+    }
+    inline size_t write(int n)
+    {
+        return write((uint8_t)n);
+    }
+
+    /**
+     * @brief Sends the packet and waits for the slave acknowledge,
+     * retrying if needed. The packet is cleared afterwards, ready
+     * for the next one.
+     * 
+     * @param address   slave address (optional)
+     * @return true     the slave acknowledged the packet
+     * @return false    something wrong happened, check lastStatus()
+     */
+    bool send(uint8_t address = 0);
+
+    /**
+     * @brief Sends the packet to every slave in a single transaction,
+     * through the general call address (0). Slaves must enable
+     * TwoWireSlaveConfig::generalCall, and TwoWireSlave::isBroadcast()
+     * tells them apart from packets sent to their own address.
+     * Broadcasts are not acknowledged, so they are not retried.
+     * The packet is cleared afterwards.
+     * 
+     * With FRAMING_STX the first byte is 0x01, which other general
+     * call devices take as a "hardware general call" and ignore.
+     * With FRAMING_COBS it would be the COBS code byte, which depends
+     * on the data and may be a general call command such as 0x06
+     * (reset and write address), so broadcasts are refused with
+     * status UNSUPPORTED and the packet is kept for send().
+     * 
+     * @return true     at least one slave received the packet
+     * @return false    no slave answered or COBS framing, check lastStatus()
+     */
+    bool broadcast();
+
+    Status lastStatus() const
+    {
+        return lastStatus_;
+    }
+
+#ifdef ARDUINO
+    String lastStatusToString() const;
+#else
+    const char *lastStatusToString() const;
+#endif
+
+private:
+#ifdef ARDUINO
+    TwoWireTransport wire_;
+#endif
+    WireTransport &transport_;
+    uint8_t address_;
+    unsigned long retryDelay_;
+    uint8_t maxAttempts_;
+    Status lastStatus_;
+
+    WirePacker packer_;
+
+    /**
+     * Reads the slave answer to the last packet, skipping stale
+     * answers to earlier ones.
+     * 
+     * @param crc       CRC of the packet, echoed by the slave
+     * @return Status   ACKNOWLEDGED, NOT_ACKNOWLEDGED or NONE
+     */
+    Status readAcknowledge(uint32_t crc);
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file WireSweep.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Polls the slaves of several master buses at once
+ * @date 2026-10-18
+ *
+ */
+#include "WireSweep.h"
+
+WireSweep::WireSweep()
+    :buses_()
+    ,busCount_(0)
+    ,onResponse_(nullptr)
+    ,readCount_(0)
+    ,failedCount_(0)
+{
+}
+
+bool WireSweep::addBus(WireSlaveRequest &request, const uint8_t *addresses, uint8_t count)
+{
+    if (busCount_ == WIRESWEEP_BUSES) {
+        return false;
+    }
+
+    Bus &bus = buses_[busCount_];
+    bus.request = &request;
+    bus.addresses = addresses;
+    bus.count = count;
+    bus.index = count;      // idle until begin()
+    ++busCount_;
+    return true;
+}
+
+void WireSweep::begin()
+{
+    readCount_ = 0;
+    failedCount_ = 0;
+
+    for (uint8_t i = 0; i < busCount_; ++i) {
+        buses_[i].index = 0;
+        startNext(i);
+    }
+}
+
+bool WireSweep::poll()
+{
+    for (uint8_t i = 0; i < busCount_; ++i) {
+        Bus &bus = buses_[i];
+
+        if (bus.index < bus.count && bus.request->poll()) {
+            finish(i);
+            ++bus.index;
+            startNext(i);
+        }
+    }
+
+    return isRunning();
+}
+
+bool WireSweep::isRunning() const
+{
+    for (uint8_t i = 0; i < busCount_; ++i) {
+        if (buses_[i].index < buses_[i].count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WireSweep::startNext(uint8_t bus)
+{
+    Bus &b = buses_[bus];
+
+    while (b.index < b.count) {
+        b.request->start(b.addresses[b.index]);
+        if (b.request->isBusy()) {
+            return;
+        }
+
+        finish(bus);
+        ++b.index;
+    }
+}
+
+void WireSweep::finish(uint8_t bus)
+{
+    Bus &b = buses_[bus];
+
+    if (b.request->lastStatus() == WireSlaveRequest::PACKET_READ) {
+        ++readCount_;
+    }
+    else {
+        ++failedCount_;
+    }
+
+    if (onResponse_) {
+        onResponse_(bus, b.addresses[b.index], *b.request);
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file WireSweep.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Polls the slaves of several master buses at once
+ * @date 2026-10-18
+ *
+ * Requesting every slave in a loop serializes the buses: while a
+ * request on Wire waits for its slave, Wire1 sits idle. WireSweep
+ * keeps one request in flight on each bus, with
+ * WireSlaveRequest::start() and poll(), so the retry delays of all
+ * buses overlap and a sweep takes about as long as its slowest bus.
+ *
+ * Each bus is given a WireSlaveRequest, which sets its transport and
+ * request options, and the addresses of its slaves. Every finished
+ * request, on any bus, is handed to the same callback:
+ *
+ *      WireSlaveRequest request0(Wire, 0, 32);
+ *      WireSlaveRequest request1(Wire1, 0, 32);
+ *      const uint8_t slaves0[] = { 0x04, 0x05 };
+ *      const uint8_t slaves1[] = { 0x04, 0x06, 0x07 };
+ *
+ *      WireSweep sweep;
+ *      sweep.addBus(request0, slaves0, 2);
+ *      sweep.addBus(request1, slaves1, 3);
+ *      sweep.onResponse(handleResponse);
+ *
+ *      sweep.begin();
+ *      while (sweep.poll()) {
+ *          // other work, or yield
+ *      }
+ *
+ * handleResponse(bus, address, request) checks request.lastStatus()
+ * and reads the payload with request.available() and read().
+ *
+ * Everything runs in the calling task; only the bus transactions
+ * themselves block. Request objects given to a sweep shouldn't use
+ * setDelta(), whose decoder follows a single slave.
+ *
+ */
+#ifndef WireSweep_h
+#define WireSweep_h
+
+#include <stdint.h>
+#include "WireSlaveRequest.h"
+
+#ifndef WIRESWEEP_BUSES
+#define WIRESWEEP_BUSES 2
+#endif
+
+class WireSweep
+{
+public:
+    WireSweep();
+
+    /**
+     * Adds a bus to the sweep.
+     *
+     * @param request   request object of the bus, must stay valid
+     * @param addresses slave addresses, must stay valid
+     * @param count     number of addresses
+     * @return true     added, false if WIRESWEEP_BUSES are added
+     */
+    bool addBus(WireSlaveRequest &request, const uint8_t *addresses, uint8_t count);
+
+    /**
+     * Callback for every finished request, successful or not, in
+     * the order they finish.
+     *
+     * @param function  called as function(bus, address, request),
+     *                  bus being the index in addBus() order
+     */
+    void onResponse(void (*function)(uint8_t bus, uint8_t address, WireSlaveRequest &request))
+    {
+        onResponse_ = function;
+    }
+
+    /**
+     * Starts a sweep: the first request of every bus.
+     */
+    void begin();
+
+    /**
+     * Advances the requests of every bus, starting the next one
+     * of a bus as soon as its previous one finishes.
+     *
+     * @return true     the sweep is still running
+     */
+    bool poll();
+
+    bool isRunning() const;
+
+    /**
+     * Number of requests of the last sweep that read a packet,
+     * and that failed.
+     */
+    uint16_t readCount() const
+    {
+        return readCount_;
+    }
+
+    uint16_t failedCount() const
+    {
+        return failedCount_;
+    }
+
+private:
+    struct Bus
+    {
+        WireSlaveRequest *request;
+        const uint8_t *addresses;
+        uint8_t count;
+        uint8_t index;
+    };
+
+    Bus buses_[WIRESWEEP_BUSES];
+    uint8_t busCount_;
+    void (*onResponse_)(uint8_t, uint8_t, WireSlaveRequest&);
+    uint16_t readCount_;
+    uint16_t failedCount_;
+
+    /**
+     * Starts requests on the bus until one is in flight or its
+     * address list ends; requests that end right away, without a
+     * free buffer for instance, are reported at once.
+     */
+    void startNext(uint8_t bus);
+
+    /**
+     * Counts a finished request and hands it to the callback.
+     */
+    void finish(uint8_t bus);
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "WireTimeSync.h"
+#include "WirePacker.h"
+#include "WireUnpacker.h"
+
+#ifdef ARDUINO
+WireTimeSync::WireTimeSync(TwoWire &wire, uint8_t address)
+    :wire_(wire)
+    ,transport_(wire_)
+    ,address_(address)
+    ,retryDelay_(1)
+    ,maxAttempts_(20)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,lastStatus_(NONE)
+    ,offset_(0)
+    ,roundTrip_(0)
+{
+}
+#endif
+
+WireTimeSync::WireTimeSync(WireTransport &transport, uint8_t address)
+    :transport_(transport)
+    ,address_(address)
+    ,retryDelay_(1)
+    ,maxAttempts_(20)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,crcWidth_(CRC_8)
+    ,lastStatus_(NONE)
+    ,offset_(0)
+    ,roundTrip_(0)
+{
+}
+
+bool WireTimeSync::sync(uint8_t address)
+{
+    if (address != 0) {
+        address_ = address;
+    }
+
+    // t1, t2, t3 and t4
+    uint32_t times[4];
+    times[0] = transport_.micros();
+    if (!sendTimes(times, 1)) {
+        lastStatus_ = SLAVE_NOT_FOUND;
+        return false;
+    }
+
+    uint8_t answer[PACKER_BUFFER_LENGTH];
+    uint8_t answerLength = wireFrameLength(wirePacketLength(12, isFecEnabled_, crcWidth_), framing_);
+
+    uint8_t attempts = 0;
+    for (; attempts < maxAttempts_; ++attempts) {
+        transport_.delay(retryDelay_);
+
+        times[3] = transport_.micros();
+        size_t returned = transport_.read(address_, answer, answerLength);
+        if (returned == 0) {
+            lastStatus_ = SLAVE_NOT_FOUND;
+            return false;
+        }
+
+        WireUnpacker unpacker;
+        unpacker.setFraming(framing_);
+        unpacker.setFec(isFecEnabled_);
+        unpacker.write(answer, returned);
+
+        if (unpacker.isPacketOpen() || unpacker.hasError()
+                || unpacker.frameType() != FRAME_SYNC || unpacker.available() != 12) {
+            // not answered yet
+            continue;
+        }
+
+        uint32_t echo = 0;
+        for (uint8_t i = 0; i < 3; ++i) {
+            uint32_t value = 0;
+            for (uint8_t j = 0; j < 4; ++j) {
+                value |= uint32_t(unpacker.read()) << (8 * j);
+            }
+            if (i == 0) {
+                echo = value;
+            }
+            else {
+                times[i] = value;
+            }
+        }
+
+        if (echo == times[0]) {
+            break;
+        }
+        // answer to an older exchange
+    }
+
+    if (attempts == maxAttempts_) {
+        lastStatus_ = MAX_ATTEMPTS;
+        return false;
+    }
+
+    // offset = ((t2 - t1) + (t3 - t4)) / 2, keeping clock wraps
+    uint32_t forward = times[1] - times[0];
+    uint32_t backward = times[2] - times[3];
+    offset_ = forward + int32_t(backward - forward) / 2;
+    roundTrip_ = (times[3] - times[0]) - (times[2] - times[1]);
+
+    // the slave computes the same offset
+    if (!sendTimes(times, 4)) {
+        lastStatus_ = SLAVE_NOT_FOUND;
+        return false;
+    }
+
+    lastStatus_ = SYNCED;
+    return true;
+}
+
+bool WireTimeSync::sendTimes(const uint32_t *times, uint8_t count)
+{
+    WirePacker packer;
+    packer.setFraming(framing_);
+    packer.setFec(isFecEnabled_);
+    packer.setCrc(crcWidth_);
+    packer.reset(FRAME_SYNC);
+
+    for (uint8_t i = 0; i < count; ++i) {
+        for (uint8_t j = 0; j < 4; ++j) {
+            packer.write(uint8_t(times[i] >> (8 * j)));
+        }
+    }
+    packer.end();
+
+    uint8_t packet[PACKER_BUFFER_LENGTH];
+    size_t packetLength = packer.read(packet, sizeof(packet));
+
+    return transport_.write(address_, packet, packetLength);
+}
+
+#ifdef ARDUINO
+String WireTimeSync::lastStatusToString() const
+#else
+const char *WireTimeSync::lastStatusToString() const
+#endif
+{
+    switch (lastStatus_) {
+    case NONE: return "none";
+    case SYNCED: return "synced";
+    case SLAVE_NOT_FOUND: return "slave not found";
+    case MAX_ATTEMPTS: return "max attempts";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * @file WireTimeSync.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Clock synchronization between the master and a slave
+ * @date 2026-10-18
+ *
+ * Keeps the micros() clock of an ESP32 slave in step with the
+ * master clock, NTP style, with FRAME_SYNC packets:
+ *
+ *      1. master sends t1, its clock right before the write
+ *      2. slave answers t1, t2 (its clock when update() read the
+ *         request) and t3 (its clock when the answer was queued)
+ *      3. master takes t4, its clock at the start of the read that
+ *         got the answer, and sends t1..t4 back to the slave
+ *
+ * Both sides then know the slave clock offset:
+ *      ((t2 - t1) + (t3 - t4)) / 2
+ * and the round trip (t4 - t1) - (t3 - t2), which bounds its error.
+ * The slave also measures its drift between exchanges (see
+ * TwoWireSlave::toMasterTime()), so sync() can be called seldom,
+ * every few seconds for instance.
+ *
+ * The answer is polled every retry delay, 1 ms by default, so that
+ * it doesn't wait long in the slave buffer, which would count as
+ * round trip.
+ *
+ */
+#ifndef WireTimeSync_h
+#define WireTimeSync_h
+
+#include <stdint.h>
+#include "WireTransport.h"
+#include "WireFrame.h"
+
+class WireTimeSync
+{
+public:
+    enum Status
+    {
+        NONE,
+        SYNCED,
+        SLAVE_NOT_FOUND,
+        MAX_ATTEMPTS,
+    };
+
+    /**
+     * Construct a new WireTimeSync object
+     *
+     * @param wire      TwoWire object (Wire or Wire1)
+     * @param address   slave address
+     */
+#ifdef ARDUINO
+    WireTimeSync(TwoWire &wire, uint8_t address);
+#endif
+
+    /**
+     * Construct a new WireTimeSync object on another bus
+     *
+     * @param transport bus access, see WireTransport.h
+     * @param address   slave address
+     */
+    WireTimeSync(WireTransport &transport, uint8_t address);
+
+    /**
+     * Delay in milliseconds between reads of the slave answer
+     */
+    void setRetryDelay(unsigned long retryDelay)
+    {
+        retryDelay_ = retryDelay;
+    }
+
+    /**
+     * Number of reads before giving up with an error status
+     */
+    void setAttempts(uint8_t attempts)
+    {
+        maxAttempts_ = attempts;
+    }
+
+    /**
+     * Selects the packet framing (see WireFrame.h), which must
+     * match the one used by the slave.
+     */
+    void setFraming(WireFraming framing)
+    {
+        framing_ = framing;
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec()),
+     * which must match the slave.
+     */
+    void setFec(bool enabled)
+    {
+        isFecEnabled_ = enabled;
+    }
+
+    /**
+     * Selects the CRC width (see WireFrame.h), which must match
+     * the slave.
+     */
+    void setCrc(WireCrcWidth width)
+    {
+        crcWidth_ = width;
+    }
+
+    /**
+     * @brief Makes an exchange with the slave, updating its offset
+     * and drift, and offset() and roundTrip().
+     *
+     * @param address   slave address (optional)
+     * @return true     exchange done
+     * @return false    something wrong happened, check lastStatus()
+     */
+    bool sync(uint8_t address = 0);
+
+    /**
+     * Slave clock minus master clock, in microseconds, measured
+     * by the last sync().
+     */
+    int32_t offset() const
+    {
+        return int32_t(offset_);
+    }
+
+    /**
+     * Round trip of the last sync(), in microseconds. The offset
+     * error is at most half of it.
+     */
+    uint32_t roundTrip() const
+    {
+        return roundTrip_;
+    }
+
+    /**
+     * Converts a slave micros() value to the master clock.
+     */
+    uint32_t toMasterTime(uint32_t slaveTime) const
+    {
+        return slaveTime - offset_;
+    }
+
+    Status lastStatus() const
+    {
+        return lastStatus_;
+    }
+
+#ifdef ARDUINO
+    String lastStatusToString() const;
+#else
+    const char *lastStatusToString() const;
+#endif
+
+private:
+#ifdef ARDUINO
+    TwoWireTransport wire_;
+#endif
+    WireTransport &transport_;
+    uint8_t address_;
+    unsigned long retryDelay_;
+    uint8_t maxAttempts_;
+    WireFraming framing_;
+    bool isFecEnabled_;
+    WireCrcWidth crcWidth_;
+    Status lastStatus_;
+    uint32_t offset_;
+    uint32_t roundTrip_;
+
+    /**
+     * Sends a FRAME_SYNC packet holding the given times.
+     */
+    bool sendTimes(const uint32_t *times, uint8_t count);
+};
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file WireTransport.cpp
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Bus access for the master side classes
+ * @date 2026-10-18
+ *
+ */
+#include "WireTransport.h"
+
+#ifdef ARDUINO
+
+// TwoWire receive buffer, as in the core's Wire.h
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 128
+#endif
+
+bool TwoWireTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+    wire_->beginTransmission(address);
+    wire_->write(data, length);
+    return wire_->endTransmission() == 0;
+}
+
+size_t TwoWireTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+    // the quantity of requestFrom() is a uint8_t, and TwoWire can't
+    // hold more anyway
+    if (length > I2C_BUFFER_LENGTH) {
+        length = I2C_BUFFER_LENGTH;
+    }
+
+    if (wire_->requestFrom(address, (uint8_t) length) == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    while (wire_->available() && count < length) {
+        data[count] = wire_->read();
+        ++count;
+    }
+    return count;
+}
+
+void TwoWireTransport::delay(unsigned long ms)
+{
+    ::delay(ms);
+}
+
+uint32_t TwoWireTransport::micros()
+{
+    return ::micros();
+}
+
+#endif      // ifdef ARDUINO
@@ -0,0 +1,115 @@
+/**
+ * @file WireTransport.h
+ * @author Gutierrez PS <https://github.com/gutierrezps>
+ * @brief Bus access for the master side classes
+ * @date 2026-10-18
+ *
+ * WireSlaveRequest and WireSlaveWrite reach the bus through a
+ * WireTransport, so the same packet handling runs on any I2C
+ * master:
+ *      TwoWireTransport: Arduino TwoWire object (Wire or Wire1),
+ *          used when those classes are given a TwoWire object
+ *      WireLinuxTransport: Linux i2c-dev device (/dev/i2c-N), see
+ *          WireLinuxTransport.h
+ *
+ * Other masters, or a fake bus in a host test, only need to
+ * implement write(), read(), delay() and micros().
+ *
+ */
+#ifndef WireTransport_h
+#define WireTransport_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Wire.h>
+#endif
+
+class WireTransport
+{
+public:
+    virtual ~WireTransport() {}
+
+    /**
+     * Writes bytes to a slave in a single transaction.
+     *
+     * @param address   slave address (0 for general call)
+     * @param data      bytes to write
+     * @param length    number of bytes, 0 for an address-only probe
+     *                  (see WireScanner.h)
+     * @return true     the slave acknowledged the transaction
+     */
+    virtual bool write(uint8_t address, const uint8_t *data, size_t length) = 0;
+
+    /**
+     * Reads bytes from a slave in a single transaction.
+     *
+     * @param address   slave address
+     * @param data      destination array
+     * @param length    number of bytes to read
+     * @return size_t   number of bytes read, 0 if the slave didn't answer
+     */
+    virtual size_t read(uint8_t address, uint8_t *data, size_t length) = 0;
+
+    /**
+     * Writes bytes to a slave and reads its answer. The default is a
+     * write() followed by a read(); transports that can do both in
+     * one transaction (repeated start) override it.
+     *
+     * @param address       slave address
+     * @param output        bytes to write
+     * @param outputLength  number of bytes to write
+     * @param input         destination array
+     * @param inputLength   number of bytes to read
+     * @return size_t       number of bytes read, 0 if the slave didn't answer
+     */
+    virtual size_t writeRead(uint8_t address, const uint8_t *output, size_t outputLength,
+            uint8_t *input, size_t inputLength)
+    {
+        if (!write(address, output, outputLength)) {
+            return 0;
+        }
+        return read(address, input, inputLength);
+    }
+
+    /**
+     * Waits while the slave prepares its answer.
+     *
+     * @param ms    milliseconds
+     */
+    virtual void delay(unsigned long ms) = 0;
+
+    /**
+     * Master clock in microseconds, used to time probes (see
+     * WireScanner.h) and to timestamp transactions (see
+     * WireTimeSync.h). Wraps around like Arduino micros().
+     */
+    virtual uint32_t micros() = 0;
+};
+
+#ifdef ARDUINO
+
+class TwoWireTransport : public WireTransport
+{
+public:
+    /**
+     * @param wire  TwoWire object (Wire or Wire1)
+     */
+    TwoWireTransport(TwoWire &wire = Wire)
+        :wire_(&wire)
+    {
+    }
+
+    bool write(uint8_t address, const uint8_t *data, size_t length);
+    size_t read(uint8_t address, uint8_t *data, size_t length);
+    void delay(unsigned long ms);
+    uint32_t micros();
+
+private:
+    TwoWire *wire_;
+};
+
+#endif      // ifdef ARDUINO
+
+#endif
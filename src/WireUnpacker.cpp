@@ -7,6 +7,7 @@
  */
 #include "WireUnpacker.h"
 #include "WireCrc.h"
+#include "WireFec.h"
 
 WireUnpacker::WireUnpacker()
     :index_(0)
@@ -14,20 +15,31 @@ WireUnpacker::WireUnpacker()
     ,payloadLength_(0)
     ,isPacketOpen_(false)
     ,expectedLength_(0)
-    ,expectedCrc_(0)
+    ,crc_(0)
+    ,frameType_(FRAME_DATA)
+    ,crcWidth_(CRC_8)
+    ,framing_(FRAMING_STX)
+    ,isFecEnabled_(false)
+    ,correctedBits_(0)
     ,lastError_(WireUnpacker::NONE)
 {
 }
 
 size_t WireUnpacker::write(uint8_t data)
 {
+    if (framing_ == FRAMING_COBS) {
+        return writeCobs(data);
+    }
+
     if (totalLength_ >= UNPACKER_BUFFER_LENGTH || hasError()) {
         return 0;
     }
 
     if (!isPacketOpen_) {
         // enable writing only if buffer is empty
-        if (totalLength_ == 0 && data == frameStart_) {
+        if (totalLength_ == 0 && isWireFrameType(data)) {
+            frameType_ = wireFrameType(data);
+            crcWidth_ = wireCrcWidth(data);
             isPacketOpen_ = true;
             ++totalLength_;
             return 1;
@@ -36,10 +48,12 @@ size_t WireUnpacker::write(uint8_t data)
     }
 
     // first byte after start is packet length
-    if (expectedLength_ == 0) {
+    if (totalLength_ == 1) {
         expectedLength_ = data;
 
-        if (expectedLength_ > UNPACKER_BUFFER_LENGTH) {
+        // a packet has at least start, length, crc and end bytes
+        if (expectedLength_ < wirePacketLength(0, false, crcWidth_)
+                || expectedLength_ > UNPACKER_BUFFER_LENGTH) {
             isPacketOpen_ = false;
             lastError_ = INVALID_LENGTH;
             return 0;
@@ -67,22 +81,156 @@ size_t WireUnpacker::write(uint8_t data)
         return 0;
     }
 
-    // ignore start, length, crc and end bytes
-    payloadLength_ = totalLength_ - 4;
+    // payload and crc bytes
+    return checkPacket(0, index_);
+}
+
+size_t WireUnpacker::checkPacket(uint8_t offset, uint8_t length)
+{
+    uint8_t *payload = buffer_ + offset;
+    correctedBits_ = 0;
+
+    if (isFecEnabled_) {
+        if (length % 2 != 0) {
+            lastError_ = INVALID_LENGTH;
+            return 0;
+        }
+
+        // decode to the buffer start, never ahead of the codewords
+        length /= 2;
+        for (uint8_t i = 0; i < length; ++i) {
+            int fixed = WireFec::decode(payload + 2 * i, buffer_[i]);
+
+            if (fixed < 0) {
+                lastError_ = UNCORRECTABLE;
+                return 0;
+            }
+            correctedBits_ += fixed;
+        }
+        payload = buffer_;
+    }
+
+    // last bytes are the crc, least significant first
+    uint8_t crcLength = wireCrcLength(crcWidth_);
+    if (length < crcLength) {
+        lastError_ = INVALID_LENGTH;
+        return 0;
+    }
+    payloadLength_ = length - crcLength;
 
-    WireCrc crc8;
-    crc8.calc(&expectedLength_, 1);     // add length to CRC
-    uint8_t crc = crc8.update(buffer_, payloadLength_);
+    uint32_t crc = wirePacketCrc(crcWidth_, expectedLength_, payload, payloadLength_);
 
-    if (crc != buffer_[index_-1]) {
+    uint32_t packetCrc = 0;
+    for (uint8_t i = 0; i < crcLength; ++i) {
+        packetCrc |= uint32_t(payload[payloadLength_ + i]) << (8 * i);
+    }
+
+    if (crc != packetCrc) {
         lastError_ = INVALID_CRC;
         return 0;
     }
+    crc_ = crc;
+
+    if (payload != buffer_) {
+        memmove(buffer_, payload, payloadLength_);
+    }
 
     index_ = 0;
     return 1;
 }
 
+size_t WireUnpacker::writeCobs(uint8_t data)
+{
+    if (hasError()) {
+        return 0;
+    }
+
+    if (data != 0) {
+        if (!isPacketOpen_) {
+            // enable writing only if buffer is empty
+            if (totalLength_ != 0) {
+                return 0;
+            }
+            isPacketOpen_ = true;
+            frameType_ = FRAME_DATA;
+        }
+
+        // type and length are never 0, so a packet starts with
+        // a code of at least 3 followed by the type
+        if ((totalLength_ == 0 && data < 3)
+                || (totalLength_ == 1 && !isWireFrameType(data))) {
+            isPacketOpen_ = false;
+            totalLength_ = 0;
+            return 0;
+        }
+
+        // as with start bytes, the type holds for the error paths too
+        if (totalLength_ == 1) {
+            frameType_ = wireFrameType(data);
+            crcWidth_ = wireCrcWidth(data);
+        }
+
+        if (totalLength_ >= UNPACKER_BUFFER_LENGTH) {
+            isPacketOpen_ = false;
+            lastError_ = INVALID_LENGTH;
+            return 0;
+        }
+
+        buffer_[totalLength_] = data;
+        ++totalLength_;
+
+        // so the length byte is the third one, unchanged by COBS
+        if (totalLength_ == 3) {
+            expectedLength_ = data;
+        }
+        return 1;
+    }
+
+    // delimiter, ignored if there's no packet
+    if (!isPacketOpen_) {
+        return 0;
+    }
+
+    isPacketOpen_ = false;
+
+    uint8_t encodedLength = totalLength_;
+    ++totalLength_;
+
+    // decode in place, output never gets ahead of input
+    uint8_t in = 0;
+    uint8_t out = 0;
+    while (in < encodedLength) {
+        uint8_t code = buffer_[in];
+        ++in;
+
+        for (uint8_t i = 1; i < code; ++i) {
+            if (in >= encodedLength) {
+                lastError_ = INVALID_LENGTH;
+                return 0;
+            }
+            buffer_[out] = buffer_[in];
+            ++out;
+            ++in;
+        }
+
+        if (code < 0xFF && in < encodedLength) {
+            buffer_[out] = 0;
+            ++out;
+        }
+    }
+
+    // type, length and crc, and length counts the end byte
+    if (out < 3 || !isWireFrameType(buffer_[0]) || buffer_[1] != out + 1) {
+        lastError_ = INVALID_LENGTH;
+        return 0;
+    }
+
+    expectedLength_ = buffer_[1];
+
+    // payload and crc bytes, after type and length
+    return checkPacket(2, out - 2);
+}
+
 size_t WireUnpacker::write(const uint8_t *data, size_t quantity)
 {
     for (size_t i = 0; i < quantity; ++i) {
@@ -95,7 +243,7 @@ size_t WireUnpacker::write(const uint8_t *data, size_t quantity)
 
 size_t WireUnpacker::available(void)
 {
-    if (isPacketOpen_) return 0;
+    if (isPacketOpen_ || hasError()) return 0;
 
     return payloadLength_ - index_;
 }
@@ -103,7 +251,7 @@ size_t WireUnpacker::available(void)
 int WireUnpacker::read(void)
 {
     int value = -1;
-    if (!isPacketOpen_ && index_ < payloadLength_) {
+    if (!isPacketOpen_ && !hasError() && index_ < payloadLength_) {
         value = buffer_[index_];
         ++index_;
     }
@@ -130,6 +278,9 @@ void WireUnpacker::printToSerial()
     case INVALID_LENGTH:
         Serial.print("invalid length, ");
         break;
+    case UNCORRECTABLE:
+        Serial.print("uncorrectable, ");
+        break;
     default: ;
     }
     
@@ -161,7 +312,9 @@ void WireUnpacker::reset()
 {
     index_ = 0;
     totalLength_ = 0;
+    payloadLength_ = 0;
     expectedLength_ = 0;
+    crc_ = 0;
     isPacketOpen_ = false;
     lastError_ = WireUnpacker::NONE;
 }
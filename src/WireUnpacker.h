@@ -15,10 +15,11 @@
  * 
  * lastError() will indicate if there was an error while
  * collecting packet bytes, such as invalid length,
- * premature ending or invalid crc.
+ * premature ending, invalid crc, or too many flipped bits
+ * for FEC to correct.
  * 
  * Expected packet format:
- *      [0]: start byte (0x02)
+ *      [0]: start byte, packet type (0x02 for data, see WireFrame.h)
  *      [1]: packet length
  *      [2]: data[0]
  *      [3]: data[1]
@@ -27,11 +28,26 @@
  *      [n+2]: CRC8 of packet length and data
  *      [n+3]: end byte (0x04)
  * 
+ * Packets with a wider CRC (see WireFrame.h) are detected from
+ * the start byte and checked the same way, crcWidth() tells which.
+ * 
+ * With FEC enabled (setFec()), every data byte and CRC byte is
+ * replaced by two WireFec codewords.
+ * 
+ * With FRAMING_COBS, bytes 0 to n+2 are COBS encoded and
+ * the end byte is replaced by a 0x00 delimiter (see WireFrame.h).
+ * 
  */
 #ifndef WireUnpacker_h
 #define WireUnpacker_h
 
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include <stddef.h>
+#include <string.h>
+#endif
+#include "WireFrame.h"
 
 #define UNPACKER_BUFFER_LENGTH 128
 
@@ -45,7 +61,8 @@ public:
     {
         NONE = 0,
         INVALID_CRC,
-        INVALID_LENGTH
+        INVALID_LENGTH,
+        UNCORRECTABLE
     };
 
     WireUnpacker();
@@ -74,12 +91,22 @@ public:
 
     /**
      * Returns number of payload bytes available to be read.
-     * Will also return 0 if the packet wasn't processed.
+     * Will also return 0 if the packet wasn't processed or is invalid.
      * 
      * @return size_t
      */
     size_t available();
 
+    /**
+     * Returns the payload bytes not read yet, available() of them,
+     * so they can be used in place instead of read one by one.
+     * 
+     */
+    const uint8_t *payload() const
+    {
+        return buffer_ + index_;
+    }
+
     /**
      * Read the next available payload byte. At each call,
      * the value returned by available() will be decremented.
@@ -122,6 +149,89 @@ public:
         return totalLength_;
     }
 
+    /**
+     * Selects how packets are framed (see WireFrame.h). Must match
+     * the framing used by the sender.
+     * 
+     * @param framing   FRAMING_STX (default) or FRAMING_COBS
+     */
+    void setFraming(WireFraming framing)
+    {
+        framing_ = framing;
+        reset();
+    }
+
+    WireFraming framing() const
+    {
+        return framing_;
+    }
+
+    /**
+     * Enables forward error correction (see WirePacker::setFec()),
+     * which must match the sender.
+     * 
+     * @param enabled   true to enable FEC
+     */
+    void setFec(bool enabled)
+    {
+        isFecEnabled_ = enabled;
+        reset();
+    }
+
+    bool isFecEnabled() const
+    {
+        return isFecEnabled_;
+    }
+
+    /**
+     * Returns how many bits were corrected by FEC in the
+     * last packet. If there were too many flipped bits,
+     * lastError() is UNCORRECTABLE instead.
+     * 
+     */
+    uint8_t correctedBits() const
+    {
+        return correctedBits_;
+    }
+
+    /**
+     * Returns the type (start byte) of the current packet.
+     * 
+     */
+    WireFrameType frameType() const
+    {
+        return frameType_;
+    }
+
+    /**
+     * Returns the CRC width of the current packet.
+     * 
+     */
+    WireCrcWidth crcWidth() const
+    {
+        return crcWidth_;
+    }
+
+    /**
+     * Returns the packet length announced by the length byte,
+     * or 0 if it wasn't read yet.
+     * 
+     */
+    uint8_t expectedLength() const
+    {
+        return expectedLength_;
+    }
+
+    /**
+     * Returns the CRC of the last intact packet, 0 if there's
+     * none.
+     * 
+     */
+    uint32_t crc() const
+    {
+        return crc_;
+    }
+
     /**
      * Debug. Prints packet data to Serial.
      * 
@@ -131,7 +241,6 @@ public:
     #endif
 
 private:
-    const uint8_t frameStart_ = 0x02;
     const uint8_t frameEnd_ = 0x04;
 
     uint8_t buffer_[UNPACKER_BUFFER_LENGTH];
@@ -140,9 +249,30 @@ private:
     uint8_t payloadLength_;
     bool isPacketOpen_;
     uint8_t expectedLength_;
-    uint8_t expectedCrc_;
+    uint32_t crc_;
+    WireFrameType frameType_;
+    WireCrcWidth crcWidth_;
+    WireFraming framing_;
+    bool isFecEnabled_;
+    uint8_t correctedBits_;
 
     Error lastError_;
+
+    /**
+     * write() for FRAMING_COBS: collects bytes until the 0x00
+     * delimiter, then decodes and checks the packet.
+     */
+    size_t writeCobs(uint8_t data);
+
+    /**
+     * Decodes FEC codewords, if enabled, and checks the CRC of
+     * a complete packet. Leaves the payload at the buffer start.
+     * 
+     * @param offset    index of the first payload byte in buffer_
+     * @param length    number of payload and crc bytes
+     * @return size_t   1 if the packet is valid
+     */
+    size_t checkPacket(uint8_t offset, uint8_t length);
 };
 
 #endif